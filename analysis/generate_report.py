@@ -302,7 +302,7 @@ def extract_results_object(json_files, unused_metrics):
         
         settings = data.get("settings")
         # Exclude specific entries
-        excluded_keys = {"settings", "traces"}
+        excluded_keys = {"settings", "traces", "report", "memory"}
         result_cats = {key: data.get(key) for key in data if key not in excluded_keys}
         
 
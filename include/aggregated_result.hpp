@@ -1,12 +1,43 @@
 #ifndef AGGREGATED_RESULT_HPP
 #define AGGREGATED_RESULT_HPP
 
+#include <optional>
+
+#include "memory_account.hpp"
+#include "report.hpp"
 #include "result.hpp"
 
 namespace palloc {
+/**
+ * Totals of runs added in run order. Durations and costs are kept per run so they are summed in
+ * the same order however the runs were produced.
+ */
+class RunTotals {
+   public:
+    void add(const Result &result);
+
+   private:
+    friend class AggregatedResult;
+
+    SimulatorSettings _simSettings{};
+    DoubleVector _durationVec;
+    DoubleVector _costVec;
+    size_t _totalRunVariables{};
+    size_t _droppedRequests{};
+    Uint _requestsGenerated{};
+    size_t _requestsScheduled{};
+    size_t _requestsUnassigned{};
+    size_t _processedRequests{};
+    size_t _batches{};
+    size_t _fastPathBatches{};
+    std::optional<ReportBuilder> _report;
+    std::optional<std::vector<RunMemory>> _memory;
+};
+
 class AggregatedResult {
    public:
     explicit AggregatedResult(const Results &results);
+    explicit AggregatedResult(const RunTotals &totals, TraceLists traceLists);
     explicit AggregatedResult(const Path &inputPath);
 
     TraceLists getTraceLists() const noexcept;
@@ -16,6 +47,21 @@ class AggregatedResult {
     size_t getTotalDroppedRequests() const noexcept;
     size_t getTotalRequestsGenerated() const noexcept;
     size_t getTotalRequestsScheduled() const noexcept;
+    size_t getTotalBatches() const noexcept;
+    size_t getTotalFastPathBatches() const noexcept;
+
+    /**
+     * Report aggregates across runs, only present when every run collected a report
+     */
+    const std::optional<ReportAggregates> &getReport() const noexcept;
+
+    /**
+     * Peak memory of every run and resident memory per phase, only present when every run was
+     * accounted
+     */
+    const std::optional<MemoryReport> &getMemory() const noexcept;
+
+    void addMemoryPhase(PhaseMemory phase);
 
     void setTimeElapsed(Uint timeElapsed) noexcept;
 
@@ -35,19 +81,25 @@ class AggregatedResult {
     size_t _requestsScheduled{};
     size_t _requestsUnassigned{};
     size_t _processedRequests{};
+    size_t _batches{};
+    size_t _fastPathBatches{};
     Uint _timeElapsed{};
+    std::optional<ReportAggregates> _report;
+    std::optional<MemoryReport> _memory;
 };
 }  // namespace palloc
 
 template <>
 struct glz::meta<palloc::AggregatedResult> {
     using T = palloc::AggregatedResult;
+    // Traces come first so merged results can stream them before the totals are known
     static constexpr auto value = glz::object(
-        "total_dropped_requests", &T::_droppedRequests, "avg_duration", &T::_avgDuration,
-        "avg_cost", &T::_avgCost, "avg_var_count", &T::_avgVariableCount, "requests_generated",
-        &T::_requestsGenerated, "requests_scheduled", &T::_requestsScheduled, "requests_unassigned",
-        &T::_requestsUnassigned, "time_elapsed", &T::_timeElapsed, "settings", &T::_simSettings,
-        "traces", &T::_traceLists);
+        "traces", &T::_traceLists, "total_dropped_requests", &T::_droppedRequests,
+        "avg_duration", &T::_avgDuration, "avg_cost", &T::_avgCost, "avg_var_count",
+        &T::_avgVariableCount, "requests_generated", &T::_requestsGenerated, "requests_scheduled",
+        &T::_requestsScheduled, "requests_unassigned", &T::_requestsUnassigned, "batches",
+        &T::_batches, "fast_path_batches", &T::_fastPathBatches, "time_elapsed", &T::_timeElapsed,
+        "settings", &T::_simSettings, "report", &T::_report, "memory", &T::_memory);
 };
 
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "environment.hpp"
 #include "glaze/glaze.hpp"
+#include "memory_account.hpp"
 #include "types.hpp"
 
 namespace palloc {
@@ -30,7 +31,8 @@ class Assignment {
     Uint _routeDuration{};
 };
 
-using Assignments = std::vector<Assignment>;
+using Assignments =
+    std::vector<Assignment, CountingAllocator<Assignment, MemoryCategory::ASSIGNMENTS>>;
 }  // namespace palloc
 
 template <>
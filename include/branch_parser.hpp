@@ -0,0 +1,28 @@
+#ifndef BRANCH_PARSER_HPP
+#define BRANCH_PARSER_HPP
+
+#include <string_view>
+#include <vector>
+
+#include "settings.hpp"
+#include "types.hpp"
+
+namespace palloc {
+class BranchParser {
+   public:
+    /**
+     * Parse branch specifications such as "batch-interval=1;batch-interval=5,commit-interval=10"
+     * into one copy of the base settings per branch. Branches are separated by ';' and overrides
+     * by ','. Only policy settings can be overridden since branches share the warm-up demand.
+     */
+    static std::vector<SimulatorSettings> parse(std::string_view branchesStr,
+                                                const SimulatorSettings &baseSettings);
+
+   private:
+    static void applyOverride(std::string_view overrideStr, SimulatorSettings &settings);
+    static Uint parseUint(std::string_view key, std::string_view value);
+    static bool parseBool(std::string_view key, std::string_view value);
+};
+}  // namespace palloc
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include "glaze/glaze.hpp"
+#include "occupancy_timeline.hpp"
+#include "report.hpp"
+#include "request.hpp"
+#include "request_source.hpp"
+#include "settings.hpp"
+#include "simulator.hpp"
+#include "trace.hpp"
+#include "types.hpp"
+
+namespace palloc {
+/**
+ * Everything a run needs to continue from the end of a timestep
+ */
+struct RunState {
+    Uint runNumber{};
+    Uint timestep{};
+    SimulatorSettings simSettings{};
+    RequestSourceState sourceState{};
+
+    Requests requests;
+    Requests unassignedRequests;
+    Requests earlyRequests;
+    Simulations simulations;
+    UintVector availableParkingSpots;
+    OccupancyTimeline timeline;
+
+    DoubleVector runCostVec;
+    TraceList traces;
+    size_t droppedRequests{};
+    Uint runDurationSum{};
+    size_t requestsScheduled{};
+    size_t totalProcessedRequests{};
+    size_t runTotalVariableCount{};
+    size_t batches{};
+    size_t fastPathBatches{};
+    // Timestep the oldest request awaiting its first batch arrived in, 0 if there is none
+    Uint pendingSince{};
+    std::optional<RunReport> report;
+};
+
+class Checkpoint {
+   public:
+    /**
+     * Write the run state as a binary snapshot, replacing any previous snapshot atomically
+     */
+    static void save(const RunState &state, const Path &checkpointPath);
+
+    /**
+     * Read a run state and make sure it was produced with the same settings
+     */
+    static RunState load(const Path &checkpointPath, const SimulatorSettings &simSettings,
+                         Uint runNumber);
+};
+}  // namespace palloc
+
+template <>
+struct glz::meta<palloc::RunState> {
+    using T = palloc::RunState;
+    static constexpr auto value = glz::object(
+        "run_number", &T::runNumber, "timestep", &T::timestep, "settings", &T::simSettings,
+        "source_state", &T::sourceState, "requests", &T::requests, "unassigned_requests",
+        &T::unassignedRequests, "early_requests", &T::earlyRequests, "simulations",
+        &T::simulations, "available_parking_spots", &T::availableParkingSpots, "timeline",
+        &T::timeline, "run_costs",
+        &T::runCostVec, "traces", &T::traces, "dropped_requests", &T::droppedRequests,
+        "run_duration_sum", &T::runDurationSum, "requests_scheduled", &T::requestsScheduled,
+        "processed_requests", &T::totalProcessedRequests, "variable_count",
+        &T::runTotalVariableCount, "batches", &T::batches, "fast_path_batches",
+        &T::fastPathBatches, "pending_since", &T::pendingSince, "report", &T::report);
+};
+
+#endif
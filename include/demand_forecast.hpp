@@ -0,0 +1,37 @@
+#ifndef DEMAND_FORECAST_HPP
+#define DEMAND_FORECAST_HPP
+
+#include <memory>
+
+#include "environment.hpp"
+#include "settings.hpp"
+#include "simulator.hpp"
+#include "types.hpp"
+
+namespace palloc {
+/**
+ * Expected parking demand over a rolling horizon. Future requests are assumed to arrive at the rate
+ * given by the traffic weights, uniformly over the dropoffs, and to take the cheapest parking of
+ * their dropoff. Spots released by ongoing simulations within the horizon offset that demand.
+ */
+class DemandForecast {
+   public:
+    explicit DemandForecast(const Environment &env, const SimulatorSettings &simSettings);
+
+    /**
+     * Get the spots per parking that should be kept free for requests expected within the horizon
+     *
+     * @param currentTimeOfDay time of day in minutes from midnight
+     * @param simulations the ongoing simulations whose departures free up spots
+     */
+    UintVector getReservations(Uint currentTimeOfDay, const Simulations &simulations) const;
+
+   private:
+    std::shared_ptr<const TravelTimes> _travelTimes;
+    UintVector _preferringDropoffs;
+    double _requestsPerDropoff;
+    Uint _horizon;
+};
+}  // namespace palloc
+
+#endif
@@ -2,9 +2,14 @@
 #define ENVIRONMENT_HPP
 
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <vector>
 
 #include "glaze/glaze.hpp"
+#include "settings.hpp"
+#include "spatial_index.hpp"
+#include "travel_times.hpp"
 #include "types.hpp"
 
 namespace palloc {
@@ -14,18 +19,66 @@ struct Coordinate {
     double longitude;
 };
 
-class Environment {
-   public:
-    using DurationMatrix = std::vector<UintVector>;
-    using Coordinates = std::vector<Coordinate>;
+struct LoadStatistics {
+    Uint64 bytesRead;
+    double seconds;
+};
 
-    explicit Environment(const Path &environmentPath);
+using Coordinates = std::vector<Coordinate>;
 
-    const Environment::DurationMatrix &getDropoffToParking() const noexcept;
-    const Environment::DurationMatrix &getParkingToDropoff() const noexcept;
+struct EnvironmentData {
+    TravelTimes travelTimes;
+    UintVector parkingCapacities;
+    DoubleVector parkingWeights;
+    Coordinates dropoffCoords;
+    Coordinates parkingCoords;
+};
+
+class Environment {
+   public:
+    using Coordinates = palloc::Coordinates;
+
+    explicit Environment(const Path &environmentPath, const StorageSettings &storageSettings = {});
+    explicit Environment(EnvironmentData data);
+
+    /**
+     * Travel times are immutable and shared between copies of the environment
+     */
+    const std::shared_ptr<const TravelTimes> &getTravelTimes() const noexcept;
+
+    Uint getDropoffToParking(Uint dropoffNode, Uint parkingNode) const noexcept;
+    Uint getParkingToDropoff(Uint parkingNode, Uint dropoffNode) const noexcept;
+    Uint getRoundTrip(Uint dropoffNode, Uint parkingNode) const noexcept;
+
+    /**
+     * Get the integer objective cost of an entry in a dropoff's travel times, which is the round
+     * trip duration optionally scaled by the parking weight and rounded
+     */
+    Int64 getCost(const TravelTimes::Row &row, size_t entry,
+                  bool useWeightedParking) const noexcept;
+
+    /**
+     * Whether coordinates and travel times allow getReachableParkings to prune
+     */
+    bool canPruneParkings() const noexcept;
+
+    /**
+     * Get the parkings whose straight-line distance to a dropoff still allows a round trip within
+     * the budget, given the fastest travel speed observed in the environment. This is a superset
+     * of the feasible parkings in ascending order
+     *
+     * @param parkings reused buffer which is overwritten with the parking indices
+     */
+    void getReachableParkings(Uint dropoffNode, Uint roundTripBudget,
+                              SpatialIndex::Indices &parkings) const;
 
     UintVector &getAvailableParkingSpots() noexcept;
+    const UintVector &getAvailableParkingSpots() const noexcept;
 
+    /**
+     * Shortest round trip of every dropoff among the kept travel times, requests shorter than it
+     * can never be assigned
+     */
     const UintVector &getSmallestRoundTrips() const noexcept;
     const DoubleVector &getParkingWeights() const noexcept;
 
@@ -35,18 +88,39 @@ class Environment {
     size_t getNumberOfDropoffs() const noexcept;
     size_t getNumberOfParkings() const noexcept;
 
+    const LoadStatistics &getLoadStatistics() const noexcept;
+
+    /**
+     * Heap bytes owned by a copy of the environment, which excludes the shared travel times and
+     * parking index
+     */
+    size_t getCopiedBytes() const noexcept;
+
    private:
-    void loadEnvironment(const Path &environmentPath);
+    void loadEnvironment(const Path &environmentPath, const StorageSettings &storageSettings);
+    void initialize(EnvironmentData data);
+    void precomputeCosts();
+    void buildSpatialIndex();
 
-    friend struct glz::meta<Environment>;
+    static Point project(const Coordinate &coordinate, double referenceLatitude) noexcept;
 
-    DurationMatrix _dropoffToParking;
-    DurationMatrix _parkingToDropoff;
     UintVector _availableParkingSpots;
     UintVector _smallestRoundTrips;
     DoubleVector _parkingWeights;
     Coordinates _dropoffCoords;
     Coordinates _parkingCoords;
+    LoadStatistics _loadStatistics{};
+
+    std::shared_ptr<const TravelTimes> _travelTimes;
+    // Weighted costs of every travel time entry, derived at load time
+    std::shared_ptr<const UintVector> _weightedCosts;
+
+    // Parkings indexed by projected position and the largest straight-line speed in meters per
+    // minute implied by any round trip. Shared like the travel times, and null when pruning is
+    // unavailable
+    std::shared_ptr<const SpatialIndex> _parkingIndex;
+    std::shared_ptr<const std::vector<Point>> _projectedDropoffs;
+    double _maxSpeed{};
 };
 }  // namespace palloc
 
@@ -56,14 +130,4 @@ struct glz::meta<palloc::Coordinate> {
     static constexpr auto value = glz::object("lat", &T::latitude, "lon", &T::longitude);
 };
 
-template <>
-struct glz::meta<palloc::Environment> {
-    using T = palloc::Environment;
-    static constexpr auto value = glz::object(
-        "dropoff_to_parking", &T::_dropoffToParking, "parking_to_dropoff", &T::_parkingToDropoff,
-        "parking_capacities", &T::_availableParkingSpots, "dropoff_coords", &T::_dropoffCoords,
-        "parking_coords", &T::_parkingCoords, "smallest_round_trips", &T::_smallestRoundTrips,
-        "parking_weights", &T::_parkingWeights);
-};
-
 #endif
\ No newline at end of file
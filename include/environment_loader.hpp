@@ -0,0 +1,74 @@
+#ifndef ENVIRONMENT_LOADER_HPP
+#define ENVIRONMENT_LOADER_HPP
+
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "environment.hpp"
+#include "settings.hpp"
+#include "travel_times.hpp"
+#include "types.hpp"
+
+namespace palloc {
+/**
+ * Streaming parser for environment files. The file is read in fixed size chunks and the duration
+ * matrices are handed to the travel time builder one row at a time, so neither the file nor a
+ * dense matrix is ever held in memory. Dimensions are checked against every array read so far.
+ */
+class EnvironmentLoader {
+   public:
+    explicit EnvironmentLoader(const Path &environmentPath, const StorageSettings &storageSettings,
+                               size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    EnvironmentData load();
+
+    Uint64 getBytesRead() const noexcept;
+
+   private:
+    void readDurationMatrix(bool isDropoffMatrix, TravelTimesBuilder &builder);
+    void readUintArray(UintVector &values);
+    void readDoubleArray(DoubleVector &values);
+    void readCoordinates(Environment::Coordinates &coordinates);
+    Coordinate readCoordinate();
+
+    /**
+     * Read the elements of an array, calling readElement with the reader positioned at each
+     */
+    template <typename F>
+    void readArray(F &&readElement);
+
+    std::string_view readString();
+    std::string_view readNumber();
+    Uint readUint();
+    double readDouble();
+    void skipValue();
+
+    bool fillBuffer();
+    char peek();
+    char get();
+    void skipWhitespace();
+    void expect(char expected);
+
+    void checkDimension(std::optional<size_t> &dimension, size_t actual, std::string_view key);
+    [[noreturn]] void fail(std::string_view message) const;
+
+    Path _environmentPath;
+    StorageSettings _storageSettings;
+    std::ifstream _file;
+    std::vector<char> _buffer;
+    size_t _position{};
+    size_t _size{};
+    Uint64 _bytesRead{};
+    std::string _token;
+    UintVector _row;
+    std::optional<size_t> _numberOfDropoffs;
+    std::optional<size_t> _numberOfParkings;
+
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+};
+}  // namespace palloc
+
+#endif
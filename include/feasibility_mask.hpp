@@ -0,0 +1,43 @@
+#ifndef FEASIBILITY_MASK_HPP
+#define FEASIBILITY_MASK_HPP
+
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "travel_times.hpp"
+#include "types.hpp"
+
+namespace palloc {
+/**
+ * Packed bitmask of the entries of a travel time row whose round trip fits in a budget, with
+ * entry k at bit k % 64 of word k / 64. The row is scanned with AVX-512 or AVX2 when the CPU
+ * supports it, which is chosen once per process.
+ */
+class FeasibilityMask {
+   public:
+    using Durations = std::span<const TravelTimes::Duration>;
+    // Allocated from the caller's resource so per-batch masks can live in its scratch arena
+    using Words = std::pmr::vector<Uint64>;
+
+    /**
+     * @param mask reused buffer which is overwritten with a bit per entry
+     */
+    static void compute(Durations toParking, Durations toDropoff, Uint budget,
+                        Words &mask);
+
+    /**
+     * Same as compute without vector instructions
+     */
+    static void computeScalar(Durations toParking, Durations toDropoff, Uint budget,
+                              Words &mask);
+
+    /**
+     * Instruction set used by compute: avx512, avx2 or scalar
+     */
+    static std::string_view getInstructionSet() noexcept;
+};
+}  // namespace palloc
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef MEMORY_ACCOUNT_HPP
+#define MEMORY_ACCOUNT_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glaze/glaze.hpp"
+#include "types.hpp"
+
+namespace palloc {
+/**
+ * The containers whose memory is accounted to the run allocating it
+ */
+enum class MemoryCategory : size_t {
+    TRACES,
+    ASSIGNMENTS,
+    SIMULATIONS,
+    REQUESTS,
+    ENVIRONMENT,
+};
+
+inline constexpr size_t MEMORY_CATEGORIES = 5;
+
+struct CategoryMemory {
+    Uint64 peakBytes;
+    Uint64 allocations;
+};
+
+/**
+ * Peak memory of a run per category, and of all categories at once
+ */
+struct RunMemory {
+    CategoryMemory traces;
+    CategoryMemory assignments;
+    CategoryMemory simulations;
+    CategoryMemory requests;
+    CategoryMemory environment;
+    Uint64 peakBytes;
+};
+
+/**
+ * Resident memory of the process at the end of a phase of the sweep
+ */
+struct PhaseMemory {
+    std::string phase;
+    Uint64 residentBytes;
+    Uint64 peakResidentBytes;
+};
+
+struct MemoryReport {
+    std::vector<RunMemory> runs;
+    std::vector<PhaseMemory> phases;
+};
+
+/**
+ * Live bytes, peak bytes and allocation counts of one run. Allocations are attributed to the
+ * account of the allocating thread, set with MemoryScope, and threads without one are not
+ * counted, so accounting costs a thread local load when it is off.
+ */
+class MemoryAccount {
+   public:
+    explicit MemoryAccount() {}
+
+    MemoryAccount(const MemoryAccount &) = delete;
+    MemoryAccount &operator=(const MemoryAccount &) = delete;
+
+    void allocate(MemoryCategory category, size_t bytes) noexcept;
+    void deallocate(MemoryCategory category, size_t bytes) noexcept;
+
+    RunMemory getRunMemory() const noexcept;
+
+    /**
+     * Account of the calling thread, nullptr outside of a MemoryScope
+     */
+    static MemoryAccount *getCurrent() noexcept;
+
+    /**
+     * Resident and peak resident memory of the process, 0 where /proc is unavailable
+     */
+    static Uint64 getResidentBytes();
+    static Uint64 getPeakResidentBytes();
+
+    static PhaseMemory samplePhase(std::string phase);
+
+   private:
+    friend class MemoryScope;
+
+    struct Counters {
+        std::atomic<Int64> liveBytes{0};
+        std::atomic<Int64> peakBytes{0};
+        std::atomic<Uint64> allocations{0};
+
+        void add(Int64 bytes) noexcept;
+    };
+
+    CategoryMemory getCategoryMemory(MemoryCategory category) const noexcept;
+
+    std::array<Counters, MEMORY_CATEGORIES> _categories;
+    Counters _total;
+};
+
+/**
+ * Attributes the allocations of the calling thread to an account while alive
+ */
+class MemoryScope {
+   public:
+    explicit MemoryScope(MemoryAccount *account) noexcept;
+    ~MemoryScope();
+
+    MemoryScope(const MemoryScope &) = delete;
+    MemoryScope &operator=(const MemoryScope &) = delete;
+
+   private:
+    MemoryAccount *_previous;
+};
+
+/**
+ * Standard allocator which reports to the account of the calling thread
+ */
+template <typename T, MemoryCategory Category>
+class CountingAllocator {
+   public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = CountingAllocator<U, Category>;
+    };
+
+    CountingAllocator() noexcept = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U, Category> &) noexcept {}
+
+    T *allocate(size_t n) {
+        T *pointer = std::allocator<T>{}.allocate(n);
+        if (auto *account = MemoryAccount::getCurrent()) {
+            account->allocate(Category, n * sizeof(T));
+        }
+
+        return pointer;
+    }
+
+    void deallocate(T *pointer, size_t n) noexcept {
+        if (auto *account = MemoryAccount::getCurrent()) {
+            account->deallocate(Category, n * sizeof(T));
+        }
+
+        std::allocator<T>{}.deallocate(pointer, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U, Category> &) const noexcept {
+        return true;
+    }
+};
+}  // namespace palloc
+
+template <>
+struct glz::meta<palloc::CategoryMemory> {
+    using T = palloc::CategoryMemory;
+    static constexpr auto value =
+        glz::object("peak_bytes", &T::peakBytes, "allocations", &T::allocations);
+};
+
+template <>
+struct glz::meta<palloc::RunMemory> {
+    using T = palloc::RunMemory;
+    static constexpr auto value = glz::object(
+        "traces", &T::traces, "assignments", &T::assignments, "simulations", &T::simulations,
+        "requests", &T::requests, "environment", &T::environment, "peak_bytes", &T::peakBytes);
+};
+
+template <>
+struct glz::meta<palloc::PhaseMemory> {
+    using T = palloc::PhaseMemory;
+    static constexpr auto value =
+        glz::object("phase", &T::phase, "resident_bytes", &T::residentBytes,
+                    "peak_resident_bytes", &T::peakResidentBytes);
+};
+
+template <>
+struct glz::meta<palloc::MemoryReport> {
+    using T = palloc::MemoryReport;
+    static constexpr auto value = glz::object("runs", &T::runs, "phases", &T::phases);
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef OCCUPANCY_TIMELINE_HPP
+#define OCCUPANCY_TIMELINE_HPP
+
+#include <map>
+#include <span>
+#include <vector>
+
+#include "glaze/glaze.hpp"
+#include "types.hpp"
+
+namespace palloc {
+/**
+ * A request occupying a parking from its start timestep until the timestep its spot is released
+ */
+struct OccupancyInterval {
+    size_t request;
+    Uint start;
+    Uint end;
+};
+
+/**
+ * Requests which may at most use freeSpots spots of a parking together
+ */
+struct CapacityWindow {
+    Uint freeSpots;
+    std::vector<size_t> requests;
+};
+
+/**
+ * Known future changes of the free spots of every parking. Committed vehicles claim their spot on
+ * arrival and every vehicle releases it when leaving the parking, so the free spots at any future
+ * timestep follow from the free spots now and the changes up to that timestep.
+ */
+class OccupancyTimeline {
+   public:
+    explicit OccupancyTimeline() {}
+    explicit OccupancyTimeline(size_t numberOfParkings) : _events(numberOfParkings) {}
+
+    /**
+     * Move to the given timestep, forgetting changes which are now part of the free spots
+     */
+    void advance(Uint timestep);
+
+    void addClaim(size_t parkingNode, Uint timestep);
+    void addRelease(size_t parkingNode, Uint timestep);
+
+    /**
+     * Get the windows a set of requests must respect at a parking. At every timestep where one of
+     * the requests starts occupying the parking or its free spots change, the requests occupying it
+     * at that timestep share the free spots. Windows which cannot be exceeded are left out.
+     *
+     * @param parkingNode the parking the requests could use
+     * @param freeNow free spots of the parking at the current timestep
+     * @param intervals the occupancy of each request if it used the parking
+     */
+    std::vector<CapacityWindow> getCapacityWindows(
+        size_t parkingNode, Uint freeNow, std::span<const OccupancyInterval> intervals) const;
+
+    Uint getTimestep() const noexcept;
+
+    /**
+     * Get the timestep at which a vehicle assigned at timestep has left its parking again, matching
+     * when the simulation frees the spot
+     */
+    static Uint getReleaseTimestep(Uint timestep, Uint tillArrival, Uint requestDuration,
+                                   Uint timeToDrive) noexcept;
+
+   private:
+    friend struct glz::meta<OccupancyTimeline>;
+
+    Uint _timestep{};
+    std::vector<std::map<Uint, Int>> _events;
+};
+}  // namespace palloc
+
+template <>
+struct glz::meta<palloc::OccupancyTimeline> {
+    using T = palloc::OccupancyTimeline;
+    static constexpr auto value = glz::object("timestep", &T::_timestep, "events", &T::_events);
+};
+
+#endif
@@ -6,14 +6,22 @@
 #include <print>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <tuple>
+#include <vector>
 
 #include "argz/argz.hpp"
+#include "branch_parser.hpp"
 #include "date_parser.hpp"
 #include "environment.hpp"
+#include "feasibility_mask.hpp"
 #include "random.hpp"
+#include "scheduler.hpp"
 #include "request_generator.hpp"
+#include "service.hpp"
 #include "settings.hpp"
+#include "shard.hpp"
 #include "simulator.hpp"
 
 #endif
\ No newline at end of file
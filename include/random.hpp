@@ -30,6 +30,17 @@ class RandomEngine {
     static constexpr Uint max() { return std::numeric_limits<Uint>::max(); }
 
     virtual Uint operator()() = 0;
+
+    /**
+     * Internal state used to checkpoint and restore the engine
+     */
+    virtual Uint64 getState() const noexcept = 0;
+    virtual void setState(Uint64 state) noexcept = 0;
+
+    /**
+     * Restart the engine as if it was created with the seed
+     */
+    virtual void reseed(Uint64 seed) noexcept = 0;
 };
 
 class RandomEngineFactory {
@@ -37,6 +48,30 @@ class RandomEngineFactory {
     static std::unique_ptr<RandomEngine> create(std::string_view generatorName, Uint seed);
 };
 
+/**
+ * Derive the seed of an independent substream from a seed and a key using the splitmix64
+ * finalizer, so substreams can be chained as e.g. (seed, run, timestep)
+ */
+Uint64 mixSeed(Uint64 seed, Uint64 key) noexcept;
+
+/**
+ * Engine drawing the complement of every draw of another engine. Paired with a run drawing from
+ * the same stream, uniform samples become negatively correlated (antithetic variates).
+ */
+class AntitheticEngine : public RandomEngine {
+   public:
+    explicit AntitheticEngine(std::unique_ptr<RandomEngine> engine);
+
+    Uint operator()() final override;
+
+    Uint64 getState() const noexcept final override;
+    void setState(Uint64 state) noexcept final override;
+    void reseed(Uint64 seed) noexcept final override;
+
+   private:
+    std::unique_ptr<RandomEngine> _engine;
+};
+
 /**
  * Permuted Congruential Generator (PCG-XSH-RR-32)
  *
@@ -48,6 +83,10 @@ class PcgEngine : public RandomEngine {
 
     Uint operator()() final override;
 
+    Uint64 getState() const noexcept final override;
+    void setState(Uint64 state) noexcept final override;
+    void reseed(Uint64 seed) noexcept final override;
+
    private:
     static Uint rotr32(Uint x, Uint r) noexcept;
 
@@ -68,6 +107,10 @@ class PcgEngineFast : public RandomEngine {
 
     Uint operator()() final override;
 
+    Uint64 getState() const noexcept final override;
+    void setState(Uint64 state) noexcept final override;
+    void reseed(Uint64 seed) noexcept final override;
+
    private:
     static constexpr Uint64 _multiplier = 6364136223846793005U;
 
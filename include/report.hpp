@@ -0,0 +1,121 @@
+#ifndef REPORT_HPP
+#define REPORT_HPP
+
+#include <vector>
+
+#include "glaze/glaze.hpp"
+#include "types.hpp"
+
+namespace palloc {
+/**
+ * Measurements of a single run taken every timestep while it is simulated, so reports do not
+ * have to be recomputed from the traces
+ */
+class RunReport {
+   public:
+    explicit RunReport() {}
+    explicit RunReport(const UintVector &parkingCapacities);
+
+    void addTimestep(const UintVector &availableParkingSpots, size_t droppedRequests,
+                     double cost, double duration);
+    void addRouteDuration(Uint routeDuration);
+
+    const UintVector &getParkingCapacities() const noexcept;
+    const std::vector<Uint64> &getOccupiedSpotMinutes() const noexcept;
+    const UintVector &getAvailableSpots() const noexcept;
+    const std::vector<Uint64> &getDroppedRequests() const noexcept;
+    const DoubleVector &getCosts() const noexcept;
+    const DoubleVector &getDurations() const noexcept;
+    const std::vector<Uint64> &getRouteDurationCounts() const noexcept;
+
+   private:
+    friend struct glz::meta<RunReport>;
+
+    UintVector _parkingCapacities;
+    std::vector<Uint64> _occupiedSpotMinutes;
+
+    // One entry per timestep
+    UintVector _availableSpots;
+    std::vector<Uint64> _droppedRequests;
+    DoubleVector _costs;
+    DoubleVector _durations;
+
+    // Assignments per route duration in minutes
+    std::vector<Uint64> _routeDurationCounts;
+};
+
+/**
+ * Mean, min and max across runs of a measurement at every timestep
+ */
+struct SeriesAggregate {
+    DoubleVector mean;
+    DoubleVector min;
+    DoubleVector max;
+};
+
+struct ReportAggregates {
+    SeriesAggregate availableSpots;
+    SeriesAggregate droppedRequests;
+    SeriesAggregate cost;
+    SeriesAggregate duration;
+    std::vector<Uint64> routeDurationHistogram;
+    // Share of the spots of every parking occupied on average
+    DoubleVector parkingUtilization;
+};
+
+/**
+ * Combines the reports of runs added in run order
+ */
+class ReportBuilder {
+   public:
+    void add(const RunReport &report);
+
+    ReportAggregates build() const;
+
+   private:
+    struct SeriesTotals {
+        DoubleVector sum;
+        DoubleVector min;
+        DoubleVector max;
+        std::vector<size_t> runs;
+
+        void add(size_t timestep, double value);
+        SeriesAggregate build() const;
+    };
+
+    SeriesTotals _availableSpots;
+    SeriesTotals _droppedRequests;
+    SeriesTotals _cost;
+    SeriesTotals _duration;
+    std::vector<Uint64> _routeDurationHistogram;
+    std::vector<Uint64> _occupiedSpotMinutes;
+    std::vector<Uint64> _spotMinutes;
+};
+}  // namespace palloc
+
+template <>
+struct glz::meta<palloc::RunReport> {
+    using T = palloc::RunReport;
+    static constexpr auto value = glz::object(
+        "parking_capacities", &T::_parkingCapacities, "occupied_spot_minutes",
+        &T::_occupiedSpotMinutes, "available_spots", &T::_availableSpots, "dropped_requests",
+        &T::_droppedRequests, "costs", &T::_costs, "durations", &T::_durations,
+        "route_duration_counts", &T::_routeDurationCounts);
+};
+
+template <>
+struct glz::meta<palloc::SeriesAggregate> {
+    using T = palloc::SeriesAggregate;
+    static constexpr auto value = glz::object("mean", &T::mean, "min", &T::min, "max", &T::max);
+};
+
+template <>
+struct glz::meta<palloc::ReportAggregates> {
+    using T = palloc::ReportAggregates;
+    static constexpr auto value = glz::object(
+        "available_spots", &T::availableSpots, "dropped_requests", &T::droppedRequests, "cost",
+        &T::cost, "duration", &T::duration, "route_duration_histogram",
+        &T::routeDurationHistogram, "parking_utilization", &T::parkingUtilization);
+};
+
+#endif
@@ -3,11 +3,14 @@
 
 #include <vector>
 
+#include "glaze/glaze.hpp"
+#include "memory_account.hpp"
 #include "types.hpp"
 
 namespace palloc {
 class Request {
    public:
+    explicit Request() {}
     explicit Request(Uint dropoffNode, Uint requestDuration, Uint tillArrival)
         : _dropoffNode(dropoffNode), _requestDuration(requestDuration), _tillArrival(tillArrival) {}
 
@@ -15,6 +18,9 @@ class Request {
     Uint getRequestDuration() const noexcept;
     Uint getTimesDropped() const noexcept;
     Uint getArrival() const noexcept;
+    Uint getId() const noexcept;
+
+    void setId(Uint id) noexcept;
 
     void decrementDuration() noexcept;
     void decrementTillArrival() noexcept;
@@ -24,13 +30,24 @@ class Request {
     bool isEarly() const noexcept;
 
    private:
-    Uint _dropoffNode;
-    Uint _requestDuration;
+    friend struct glz::meta<Request>;
+
+    Uint _dropoffNode{};
+    Uint _requestDuration{};
     Uint _timesDropped = 0;
-    Uint _tillArrival;
+    Uint _tillArrival{};
+    Uint _id{};
 };
 
-using Requests = std::vector<Request>;
+using Requests = std::vector<Request, CountingAllocator<Request, MemoryCategory::REQUESTS>>;
 }  // namespace palloc
 
+template <>
+struct glz::meta<palloc::Request> {
+    using T = palloc::Request;
+    static constexpr auto value = glz::object(
+        "dropoff", &T::_dropoffNode, "duration", &T::_requestDuration, "times_dropped",
+        &T::_timesDropped, "till_arrival", &T::_tillArrival, "id", &T::_id);
+};
+
 #endif
\ No newline at end of file
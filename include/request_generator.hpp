@@ -4,10 +4,12 @@
 #include <array>
 #include <memory>
 #include <random>
+#include <stdexcept>
 #include <string>
 
 #include "random.hpp"
 #include "request.hpp"
+#include "request_source.hpp"
 #include "types.hpp"
 
 namespace palloc {
@@ -18,16 +20,35 @@ struct RequestGeneratorOptions {
     Uint maxRequestDuration;
     Uint seed;
     double requestRate;
+    Uint run;
+    // Draw every timestep from its own substream keyed by (seed, run, timestep)
+    bool commonRandomNumbers;
+    // Odd runs draw the complements of the preceding even run
+    bool antithetic;
 };
 
-class RequestGenerator {
+class RequestGenerator : public RequestSource {
    public:
     explicit RequestGenerator(const RequestGeneratorOptions &options)
         : _dropoffDist(0, options.dropoffNodes - 1),
           _arrivalDist(0, options.maxTimeTillArrival),
           _maxRequestDuration(options.maxRequestDuration),
-          _requestRate(options.requestRate) {
-        _rng = random::RandomEngineFactory::create(options.randomGenerator, options.seed);
+          _requestRate(options.requestRate),
+          _commonRandomNumbers(options.commonRandomNumbers) {
+        // Without substreams the complementary draws fall out of step at the first distribution
+        // which takes a variable number of draws, leaving the pair nearly independent
+        if (options.antithetic && !options.commonRandomNumbers) {
+            throw std::invalid_argument("Antithetic runs require common random numbers");
+        }
+
+        // Antithetic pairs share the stream of their even run
+        const Uint streamRun = options.antithetic ? options.run - options.run % 2 : options.run;
+        _streamSeed = random::mixSeed(options.seed, streamRun);
+        _rng = random::RandomEngineFactory::create(options.randomGenerator,
+                                                   options.seed + streamRun);
+        if (options.antithetic && options.run % 2 == 1) {
+            _rng = std::make_unique<random::AntitheticEngine>(std::move(_rng));
+        }
 
         DoubleVector durationWeights = getDurationBuckets(options.maxRequestDuration);
         _durationDist =
@@ -39,12 +60,21 @@ class RequestGenerator {
      *
      * @param currentTimeOfDay time of day in minutes from midnight
      */
-    Requests generate(Uint currentTimeOfDay);
+    Requests generate(Uint currentTimeOfDay) final override;
 
     /**
      * Get the number of requests generated
      */
-    Uint getRequestsGenerated() const noexcept;
+    Uint getRequestsGenerated() const noexcept final override;
+
+    RequestSourceState getState() const final override;
+    void setState(const RequestSourceState &state) final override;
+
+    /**
+     * Function that returns a multiplier which changes during the day to represent parking requests
+     * as a function of time
+     */
+    static double getTimeMultiplier(Uint currentTimeOfDay);
 
    private:
     /**
@@ -72,15 +102,15 @@ class RequestGenerator {
     Uint getArrival();
 
     /**
-     * Function that returns a multiplier which changes during the day to represent parking requests
-     * as a function of time
+     * Get viable duration buckets
      */
-    static double getTimeMultiplier(Uint currentTimeOfDay);
+    static DoubleVector getDurationBuckets(Uint maxDuration);
 
     /**
-     * Get viable duration buckets
+     * Reseed the engine with one of the substreams of the current timestep, only used with
+     * common random numbers
      */
-    static DoubleVector getDurationBuckets(Uint maxDuration);
+    void enterSubstream(Uint64 substream);
 
     std::uniform_int_distribution<size_t> _dropoffDist;
     std::discrete_distribution<Uint> _durationDist;
@@ -132,6 +162,10 @@ class RequestGenerator {
     Uint _maxRequestDuration;
     double _requestRate;
     Uint _requestsGenerated = 0;
+
+    bool _commonRandomNumbers;
+    Uint64 _streamSeed;
+    Uint _timestep = 0;
 };
 }  // namespace palloc
 
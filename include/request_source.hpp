@@ -0,0 +1,143 @@
+#ifndef REQUEST_SOURCE_HPP
+#define REQUEST_SOURCE_HPP
+
+#include <array>
+#include <fstream>
+#include <memory>
+#include <optional>
+
+#include "glaze/glaze.hpp"
+#include "request.hpp"
+#include "types.hpp"
+
+namespace palloc {
+struct SimulatorSettings;  // forward
+struct OutputSettings;     // forward
+
+/**
+ * Position of a request source within its stream, used to checkpoint and resume runs
+ */
+struct RequestSourceState {
+    Uint64 rngState;
+    Uint64 offset;
+    Uint timestep;
+    Uint requestsGenerated;
+};
+
+/**
+ * Interface for anything that produces the requests of a run one timestep at a time
+ */
+class RequestSource {
+   public:
+    virtual ~RequestSource() = default;
+
+    /**
+     * Produce the requests of the next timestep
+     *
+     * @param currentTimeOfDay time of day in minutes from midnight
+     */
+    virtual Requests generate(Uint currentTimeOfDay) = 0;
+
+    /**
+     * Get the number of requests produced so far
+     */
+    virtual Uint getRequestsGenerated() const noexcept = 0;
+
+    virtual RequestSourceState getState() const = 0;
+    virtual void setState(const RequestSourceState &state) = 0;
+
+    /**
+     * Write out everything produced so far, before a checkpoint refers to it
+     */
+    virtual void flush() {}
+};
+
+class RequestSourceFactory {
+   public:
+    /**
+     * Create the request source of a run, replaying a recording if one is configured and
+     * wrapping it in a recorder if the run should be recorded. A resumed recorder appends to the
+     * existing recording instead of truncating it.
+     */
+    static std::unique_ptr<RequestSource> create(const SimulatorSettings &simSettings,
+                                                 const OutputSettings &outputSettings,
+                                                 size_t dropoffNodes, Uint runNumber,
+                                                 bool resume = false);
+};
+
+/**
+ * Recorded requests are stored as a small header followed by fixed size little endian records of
+ * (timestep, dropoff, duration, arrival) sorted by timestep
+ */
+namespace recording {
+static constexpr std::array<char, 4> MAGIC{'P', 'R', 'E', 'Q'};
+static constexpr Uint VERSION = 1;
+
+struct Record {
+    Uint timestep;
+    Uint dropoff;
+    Uint duration;
+    Uint arrival;
+};
+}  // namespace recording
+
+/**
+ * Streams requests from a recording. With a speed above 1 several recorded timesteps are replayed
+ * in every simulated timestep.
+ */
+class ReplayRequestSource : public RequestSource {
+   public:
+    explicit ReplayRequestSource(const Path &recordingPath, Uint speed, size_t dropoffNodes);
+
+    Requests generate(Uint currentTimeOfDay) final override;
+    Uint getRequestsGenerated() const noexcept final override;
+
+    RequestSourceState getState() const final override;
+    void setState(const RequestSourceState &state) final override;
+
+   private:
+    bool readRecord();
+
+    std::ifstream _input;
+    Path _recordingPath;
+    std::optional<recording::Record> _nextRecord;
+    Uint64 _nextRecordOffset = 0;
+    size_t _dropoffNodes;
+    Uint _speed;
+    Uint _timestep = 0;
+    Uint _requestsGenerated = 0;
+};
+
+/**
+ * Forwards requests from another source while appending them to a recording
+ */
+class RecordingRequestSource : public RequestSource {
+   public:
+    explicit RecordingRequestSource(std::unique_ptr<RequestSource> source,
+                                    const Path &recordingPath, bool append = false);
+
+    Requests generate(Uint currentTimeOfDay) final override;
+    Uint getRequestsGenerated() const noexcept final override;
+
+    RequestSourceState getState() const final override;
+    void setState(const RequestSourceState &state) final override;
+    void flush() final override;
+
+   private:
+    std::unique_ptr<RequestSource> _source;
+    std::ofstream _output;
+    Path _recordingPath;
+    Uint64 _offset = 0;
+    Uint _timestep = 0;
+};
+}  // namespace palloc
+
+template <>
+struct glz::meta<palloc::RequestSourceState> {
+    using T = palloc::RequestSourceState;
+    static constexpr auto value =
+        glz::object("rng_state", &T::rngState, "offset", &T::offset, "timestep", &T::timestep,
+                    "requests_generated", &T::requestsGenerated);
+};
+
+#endif
@@ -1,8 +1,11 @@
 #ifndef RESULT_HPP
 #define RESULT_HPP
 
+#include <optional>
 #include <vector>
 
+#include "memory_account.hpp"
+#include "report.hpp"
 #include "settings.hpp"
 #include "trace.hpp"
 #include "types.hpp"
@@ -14,10 +17,12 @@ using Results = std::vector<Result>;
 
 class Result {
    public:
+    explicit Result() {}
     explicit Result(TraceList traceList, SimulatorSettings simSettings, size_t droppedRequests,
                     double totalRunDuration, double totalRunCost, size_t totalRunVariables,
                     Uint requestsGenerated, size_t requestsScheduled, size_t requestsUnassigned,
-                    size_t processedRequests)
+                    size_t processedRequests, size_t batches, size_t fastPathBatches,
+                    std::optional<RunReport> report = std::nullopt)
         : _traceList(std::move(traceList)),
           _simSettings(std::move(simSettings)),
           _droppedRequests(droppedRequests),
@@ -27,7 +32,10 @@ class Result {
           _requestsGenerated(requestsGenerated),
           _requestsScheduled(requestsScheduled),
           _requestsUnassigned(requestsUnassigned),
-          _processedRequests(processedRequests) {}
+          _processedRequests(processedRequests),
+          _batches(batches),
+          _fastPathBatches(fastPathBatches),
+          _report(std::move(report)) {}
 
     TraceList getTraceList() const noexcept;
     SimulatorSettings getSimSettings() const noexcept;
@@ -39,6 +47,12 @@ class Result {
     size_t getRequestsScheduled() const noexcept;
     size_t getRequestsUnassigned() const noexcept;
     size_t getProcessedRequests() const noexcept;
+    size_t getBatches() const noexcept;
+    size_t getFastPathBatches() const noexcept;
+    const std::optional<RunReport> &getReport() const noexcept;
+    const std::optional<RunMemory> &getMemory() const noexcept;
+
+    void setMemory(RunMemory memory) noexcept;
 
    private:
     friend struct glz::meta<Result>;
@@ -53,9 +67,27 @@ class Result {
     size_t _requestsScheduled{};
     size_t _requestsUnassigned{};
     size_t _processedRequests{};
+    size_t _batches{};
+    size_t _fastPathBatches{};
+    std::optional<RunReport> _report;
+    std::optional<RunMemory> _memory;
 };
 
 using Results = std::vector<Result>;
 }  // namespace palloc
 
+template <>
+struct glz::meta<palloc::Result> {
+    using T = palloc::Result;
+    static constexpr auto value = glz::object(
+        "settings", &T::_simSettings, "dropped_requests", &T::_droppedRequests,
+        "total_run_duration", &T::_totalRunDuration, "total_run_cost", &T::_totalRunCost,
+        "total_run_variables", &T::_totalRunVariables, "requests_generated",
+        &T::_requestsGenerated, "requests_scheduled", &T::_requestsScheduled,
+        "requests_unassigned", &T::_requestsUnassigned, "processed_requests",
+        &T::_processedRequests, "batches", &T::_batches, "fast_path_batches",
+        &T::_fastPathBatches, "report", &T::_report, "memory", &T::_memory, "traces",
+        &T::_traceList);
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+#ifndef RUN_SINK_HPP
+#define RUN_SINK_HPP
+
+#include <tuple>
+#include <utility>
+
+#include "request.hpp"
+#include "types.hpp"
+
+namespace palloc {
+class Simulation;  // forward
+
+/**
+ * A batching step, solved or not. Every field is 0 when nothing awaited a decision.
+ */
+struct BatchEvent {
+    Uint timestep;
+    size_t batchSize;
+    size_t processedRequests;
+    size_t scheduled;
+    double totalCost;
+    Uint totalDuration;
+    size_t variableCount;
+    bool usedFastPath;
+    // Timesteps the oldest request of the batch waited for it
+    Uint latency;
+
+    double getAverageCost() const noexcept {
+        return processedRequests == 0 ? 0.0 : totalCost / static_cast<double>(processedRequests);
+    }
+
+    double getAverageDuration() const noexcept {
+        return scheduled == 0 ? 0.0
+                              : static_cast<double>(totalDuration) / static_cast<double>(scheduled);
+    }
+};
+
+/**
+ * State of a run at the end of a timestep
+ */
+struct TimestepEvent {
+    Uint timestep;
+    Uint timeOfDay;
+    size_t pendingRequests;
+    size_t ongoingSimulations;
+    const UintVector &availableParkingSpots;
+    // Requests dropped since the start of the run
+    size_t droppedRequests;
+    size_t earlyRequests;
+};
+
+/**
+ * Observer of the events of a run. The run loop is instantiated once per sink type, so a sink
+ * only pays for the events it handles and an empty handler is inlined away.
+ */
+template <typename T>
+concept RunSink = requires(T sink, const BatchEvent &batch, const TimestepEvent &step,
+                           const Simulation &simulation, const Request &request, Uint timestep) {
+    sink.batchSolved(batch);
+    sink.simulationStarted(timestep, simulation);
+    sink.arrivedAtParking(timestep, simulation);
+    sink.departed(timestep, simulation);
+    sink.requestDropped(timestep, request);
+    sink.timestepEnded(step);
+};
+
+struct NullSink {
+    void batchSolved(const BatchEvent &) noexcept {}
+    void simulationStarted(Uint, const Simulation &) noexcept {}
+    void arrivedAtParking(Uint, const Simulation &) noexcept {}
+    void departed(Uint, const Simulation &) noexcept {}
+    void requestDropped(Uint, const Request &) noexcept {}
+    void timestepEnded(const TimestepEvent &) noexcept {}
+};
+
+/**
+ * Forwards every event to each of its sinks in order
+ */
+template <RunSink... Sinks>
+class SinkChain {
+   public:
+    explicit SinkChain(Sinks... sinks) : _sinks(std::move(sinks)...) {}
+
+    void batchSolved(const BatchEvent &event) {
+        forEach([&](auto &sink) { sink.batchSolved(event); });
+    }
+
+    void simulationStarted(Uint timestep, const Simulation &simulation) {
+        forEach([&](auto &sink) { sink.simulationStarted(timestep, simulation); });
+    }
+
+    void arrivedAtParking(Uint timestep, const Simulation &simulation) {
+        forEach([&](auto &sink) { sink.arrivedAtParking(timestep, simulation); });
+    }
+
+    void departed(Uint timestep, const Simulation &simulation) {
+        forEach([&](auto &sink) { sink.departed(timestep, simulation); });
+    }
+
+    void requestDropped(Uint timestep, const Request &request) {
+        forEach([&](auto &sink) { sink.requestDropped(timestep, request); });
+    }
+
+    void timestepEnded(const TimestepEvent &event) {
+        forEach([&](auto &sink) { sink.timestepEnded(event); });
+    }
+
+   private:
+    template <typename Function>
+    void forEach(Function &&function) {
+        std::apply([&](auto &...sinks) { (function(sinks), ...); }, _sinks);
+    }
+
+    std::tuple<Sinks...> _sinks;
+};
+}  // namespace palloc
+
+#endif
@@ -1,8 +1,17 @@
 #ifndef SCHEDULER_HPP
 #define SCHEDULER_HPP
 
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 #include "environment.hpp"
+#include "occupancy_timeline.hpp"
 #include "request_generator.hpp"
+#include "scratch_arena.hpp"
 #include "simulator.hpp"
 
 namespace palloc {
@@ -14,17 +23,145 @@ struct SchedulerResult {
     double totalCost;
     size_t processedRequests;
     size_t variableCount;
+    bool usedFastPath;
+    // Value of the batch objective, equal for every backend which solves the batch optimally
+    Int64 objective;
+};
+
+/**
+ * Information about the surroundings of a batch which is not part of the requests themselves
+ */
+struct SchedulerContext {
+    /**
+     * Spots per parking expected to be needed by future requests. Using them is allowed but
+     * penalized. Empty when scheduling myopically.
+     */
+    UintVector reservedSpots;
+
+    /**
+     * Known future occupancy of every parking. When given, capacity is checked over the time each
+     * request occupies its spot and early requests are committed instead of deferred.
+     */
+    const OccupancyTimeline *timeline = nullptr;
+
+    /**
+     * Memory for the scratch containers of the batch. The caller resets it once the result has
+     * been consumed. Without it the default heap is used.
+     */
+    ScratchArena *arena = nullptr;
+
+    /**
+     * Run the kernel which reads the settings flags at runtime instead of the one specialized on
+     * them, only to compare the two
+     */
+    bool genericKernels = false;
+};
+
+/**
+ * A parking a request can reach and return from in time, and the objective cost of using it
+ */
+struct Candidate {
+    Uint parkingNode;
+    Int64 cost;
+};
+
+using Candidates = std::pmr::vector<std::pmr::vector<Candidate>>;
+
+/**
+ * Every request in its cheapest feasible parking ignoring capacity. The objective of this
+ * assignment is a lower bound on the batch, so it is optimal whenever no parking is oversubscribed.
+ */
+struct GreedyAssignment {
+    std::pmr::vector<std::optional<Uint>> parkingNodes;
+    Int64 lowerBound;
+    bool isOptimal;
+};
+
+/**
+ * Parking of every request chosen by one of the models, empty when no solution was found
+ */
+struct ModelSolution {
+    std::pmr::vector<std::optional<Uint>> parkingNodes;
+    size_t variableCount;
+    bool solved;
 };
 
 class Scheduler {
    public:
     static SchedulerResult scheduleBatch(Environment &env, Requests &requests,
-                                         const SimulatorSettings &simSettings);
+                                         const SimulatorSettings &simSettings,
+                                         const SchedulerContext &context = {});
+
+    /**
+     * Get the feasible parkings of every request in ascending parking order
+     */
+    static Candidates getCandidates(
+        const Environment &env, const Requests &requests, const SimulatorSettings &simSettings,
+        std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+    /**
+     * Scratch memory is taken from the memory resource of the candidates
+     */
+    static GreedyAssignment assignGreedily(const Environment &env, const Requests &requests,
+                                           const Candidates &candidates,
+                                           const SchedulerContext &context = {});
+
+    /**
+     * Get the model objective of an assignment, which is the cost of every assigned candidate,
+     * the penalty of every unassigned request and the penalty of every reserved spot taken
+     */
+    static Int64 getObjective(const Environment &env, const Requests &requests,
+                              const Candidates &candidates,
+                              std::span<const std::optional<Uint>> parkingNodes,
+                              const SchedulerContext &context = {});
+
+    /**
+     * Scheduler backends. Auto skips the solver when the greedy assignment is optimal and
+     * otherwise solves the class model like aggregated, cp-sat always solves the request model.
+     */
+    static inline const std::unordered_set<std::string> availableBackends = {"auto", "cp-sat",
+                                                                             "aggregated"};
 
     static constexpr int MAX_SEARCH_TIME = 60000;
     static constexpr int PARKING_NODES_TO_VISIT = 1;
     static constexpr int UNASSIGNED_PENALTY = 1000;
+
+    // Cost of taking a reserved spot, roughly the detour of pushing a future request one parking
+    // further away
+    static constexpr int RESERVATION_PENALTY = 30;
+
+   private:
+    /**
+     * Schedule a batch with a kernel specialized on the settings flags given by Flags
+     */
+    template <typename Flags>
+    static SchedulerResult runBatchKernel(Environment &env, Requests &requests,
+                                          const SimulatorSettings &simSettings,
+                                          const SchedulerContext &context, Flags flags);
+
+    static Int64 getPenalty(const Request &request);
+    static Uint getUnreservedSpots(Uint availableSpots, Uint reservedSpots) noexcept;
+
+    /**
+     * Solve the batch with a boolean variable for every request and feasible parking
+     */
+    static ModelSolution solveRequestModel(const Environment &env, const Requests &requests,
+                                           const Candidates &candidates,
+                                           const SchedulerContext &context);
+
+    /**
+     * Solve the batch with interchangeable requests grouped into classes and an integer variable
+     * for the number of requests of a class in each of its feasible parkings, which removes the
+     * symmetry between identical requests
+     */
+    static ModelSolution solveClassModel(const Environment &env, const Requests &requests,
+                                         const Candidates &candidates,
+                                         const SchedulerContext &context);
+
+    static OccupancyInterval getOccupancyInterval(const Environment &env, const Request &request,
+                                                  size_t requestIndex, size_t parkingNode,
+                                                  const OccupancyTimeline &timeline);
 };
 }  // namespace palloc
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,59 @@
+#ifndef SCRATCH_ARENA_HPP
+#define SCRATCH_ARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace palloc {
+/**
+ * Monotonic memory for short-lived containers of a single batch. Everything allocated is released
+ * at once on reset, and the buffer grows to fit the largest batch seen so far, so after a few
+ * batches the upstream allocator is no longer touched.
+ */
+class ScratchArena {
+   public:
+    explicit ScratchArena(size_t initialCapacity = DEFAULT_CAPACITY);
+
+    ScratchArena(const ScratchArena &) = delete;
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    std::pmr::memory_resource *getResource() noexcept;
+
+    /**
+     * Release everything allocated since the last reset. Memory must no longer be in use.
+     */
+    void reset();
+
+    /**
+     * Number of allocations the arena could not serve from its buffer since it was created
+     */
+    size_t getUpstreamAllocations() const noexcept;
+
+    size_t getCapacity() const noexcept;
+
+   private:
+    /**
+     * Counts the allocations passed on to the default heap
+     */
+    class CountingResource : public std::pmr::memory_resource {
+       public:
+        size_t allocations{};
+        size_t bytesSinceReset{};
+
+       private:
+        void *do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+    };
+
+    std::vector<std::byte> _buffer;
+    CountingResource _upstream;
+    std::optional<std::pmr::monotonic_buffer_resource> _resource;
+
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+};
+}  // namespace palloc
+
+#endif
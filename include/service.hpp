@@ -0,0 +1,163 @@
+#ifndef SERVICE_HPP
+#define SERVICE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "environment.hpp"
+#include "glaze/glaze.hpp"
+#include "request.hpp"
+#include "scratch_arena.hpp"
+#include "settings.hpp"
+#include "simulator.hpp"
+#include "types.hpp"
+
+namespace palloc {
+using ServiceClock = std::chrono::steady_clock;
+
+/**
+ * A single line of the service protocol. Supported types:
+ *  - "request": queue a parking request (id, dropoff, duration, arrival)
+ *  - "advance": solve pending requests and advance the clock by minutes
+ *  - "flush": solve pending requests without advancing the clock
+ *  - "shutdown": solve pending requests and stop the service
+ */
+struct ServiceMessage {
+    std::string type;
+    Uint id{};
+    Uint dropoff{};
+    Uint duration{};
+    Uint arrival{};
+    Uint minutes{1};
+
+    ServiceClock::time_point receivedAt{};
+};
+
+struct ServiceAssignment {
+    Uint id;
+    Uint parking;
+    Uint routeDuration;
+};
+
+struct ServiceResponse {
+    Uint batch{};
+    Uint timestep{};
+    Uint64 solveMicros{};
+    std::vector<ServiceAssignment> assignments;
+    UintVector deferred;
+    UintVector unassigned;
+    UintVector expired;
+    UintVector rejected;
+};
+
+struct ServiceStats {
+    size_t requestsReceived;
+    size_t requestsAssigned;
+    size_t batchesSolved;
+    double elapsedSeconds;
+    double throughput;
+    double p50LatencyMicros;
+    double p99LatencyMicros;
+    double maxLatencyMicros;
+};
+
+/**
+ * Long running scheduler which keeps an environment in memory and assigns live requests in
+ * batches. A batch is solved when the batching window of the oldest pending request expires, when
+ * the batch reaches its maximum size or when the client advances the clock.
+ */
+class Service {
+   public:
+    explicit Service(Environment env, SimulatorSettings simSettings,
+                     ServiceSettings serviceSettings);
+
+    /**
+     * Serve the line protocol on stdin/stdout until shutdown or end of input
+     */
+    static void serve(Environment &env, const SimulatorSettings &simSettings,
+                      const ServiceSettings &serviceSettings);
+
+    /**
+     * Replay generated requests through an in-process service and report throughput and latency
+     */
+    static void benchmark(Environment &env, const SimulatorSettings &simSettings,
+                          const ServiceSettings &serviceSettings);
+
+    /**
+     * Queue a message for the service loop. Safe to call from any thread.
+     */
+    void submit(ServiceMessage message);
+
+    /**
+     * Process queued messages until a shutdown message, writing one response per batch
+     */
+    void run(std::ostream &out);
+
+    ServiceStats getStats() const;
+
+   private:
+    bool handleMessage(const ServiceMessage &message, std::ostream &out);
+    void queueRequest(const ServiceMessage &message);
+    void solveBatch(std::ostream &out);
+    void advance(Uint minutes);
+
+    static void writeLine(const auto &value, std::ostream &out);
+
+    Environment _env;
+    SimulatorSettings _simSettings;
+    ServiceSettings _serviceSettings;
+    ScratchArena _arena;
+
+    std::mutex _mutex;
+    std::condition_variable _messageAvailable;
+    std::deque<ServiceMessage> _messages;
+
+    Requests _pending;
+    Requests _unassigned;
+    Requests _early;
+    Simulations _simulations;
+    UintVector _expired;
+    UintVector _rejected;
+    std::unordered_map<Uint, ServiceClock::time_point> _receivedAt;
+    ServiceClock::time_point _batchDeadline{};
+
+    Uint _timestep{};
+    Uint _batchesSolved{};
+    size_t _requestsReceived{};
+    DoubleVector _latencies;
+    ServiceClock::time_point _startedAt{};
+    ServiceClock::time_point _stoppedAt{};
+};
+}  // namespace palloc
+
+template <>
+struct glz::meta<palloc::ServiceMessage> {
+    using T = palloc::ServiceMessage;
+    static constexpr auto value =
+        glz::object("type", &T::type, "id", &T::id, "dropoff", &T::dropoff, "duration",
+                    &T::duration, "arrival", &T::arrival, "minutes", &T::minutes);
+};
+
+template <>
+struct glz::meta<palloc::ServiceAssignment> {
+    using T = palloc::ServiceAssignment;
+    static constexpr auto value =
+        glz::object("id", &T::id, "parking", &T::parking, "route_duration", &T::routeDuration);
+};
+
+template <>
+struct glz::meta<palloc::ServiceResponse> {
+    using T = palloc::ServiceResponse;
+    static constexpr auto value = glz::object(
+        "batch", &T::batch, "timestep", &T::timestep, "solve_us", &T::solveMicros, "assignments",
+        &T::assignments, "deferred", &T::deferred, "unassigned", &T::unassigned, "expired",
+        &T::expired, "rejected", &T::rejected);
+};
+
+#endif
@@ -19,6 +19,19 @@ struct SimulatorSettings {
     Uint seed;
     bool useWeightedParking;
     std::string randomGenerator;
+    std::string replayFile;
+    Uint replaySpeed;
+    Uint warmupTimesteps;
+    Uint horizon;
+    bool useTimeExpanded;
+    Uint batchSize;
+    std::string schedulerBackend;
+    // Key the requests of every timestep by (seed, run, timestep) so configurations share demand
+    bool commonRandomNumbers;
+    // Pair every odd run with the complementary draws of the preceding run
+    bool antithetic;
+
+    bool operator==(const SimulatorSettings &) const = default;
 };
 
 struct OutputSettings {
@@ -26,10 +39,33 @@ struct OutputSettings {
     Uint numberOfRunsToAggregate;
     bool prettify;
     bool outputTrace;
+    // Collect per timestep aggregates across runs for reports
+    bool outputReport;
+    // Count the bytes of every run's containers and sample resident memory per phase
+    bool accountMemory;
+    Path recordPath;
+    Path checkpointPath;
+    Uint checkpointInterval;
+    bool resume;
+    // Only the jobs of shard shardIndex are simulated when shardCount is above 1
+    Uint shardIndex;
+    Uint shardCount;
 };
 
 struct GeneralSettings {
     Uint numberOfThreads;
+    // Generate requests and build traces on their own threads while each run solves its batches
+    bool pipelined;
+};
+
+struct StorageSettings {
+    Uint travelTimeCutoff;
+    Uint nearestParkings;
+};
+
+struct ServiceSettings {
+    Uint batchWindow;
+    Uint maxBatchSize;
 };
 }  // namespace palloc
 
@@ -41,7 +77,11 @@ struct glz::meta<palloc::SimulatorSettings> {
         &T::maxRequestDuration, "max_request_arrival", &T::maxTimeTillArrival, "min_parking_time",
         &T::minParkingTime, "request_rate", &T::requestRate, "batch_interval", &T::batchInterval,
         "commit_interval", &T::commitInterval, "seed", &T::seed, "using_weighted_parking",
-        &T::useWeightedParking, "random_generator", &T::randomGenerator);
+        &T::useWeightedParking, "random_generator", &T::randomGenerator, "replay_file",
+        &T::replayFile, "replay_speed", &T::replaySpeed, "warmup_timesteps", &T::warmupTimesteps,
+        "horizon", &T::horizon, "using_time_expanded", &T::useTimeExpanded,
+        "batch_size", &T::batchSize, "scheduler_backend", &T::schedulerBackend,
+        "common_random_numbers", &T::commonRandomNumbers, "antithetic", &T::antithetic);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef SHARD_HPP
+#define SHARD_HPP
+
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "glaze/glaze.hpp"
+#include "result.hpp"
+#include "settings.hpp"
+#include "types.hpp"
+
+namespace palloc {
+/**
+ * First line of a shard file, describing the sweep the shard is part of
+ */
+struct ShardHeader {
+    Uint shard;
+    Uint shardCount;
+    Uint numberOfRuns;
+    bool branching;
+    // Settings of every branch, a single entry when not branching
+    std::vector<SimulatorSettings> branchSettings;
+};
+
+/**
+ * Result of job run * branches + branch
+ */
+struct ShardJob {
+    Uint job;
+    Result result;
+};
+
+/**
+ * Last line of a shard file
+ */
+struct ShardFooter {
+    Uint timeElapsed;
+};
+
+/**
+ * A sweep of runs times branches jobs split over machines. Shard i of N simulates every job j
+ * with j % N == i and writes one line per job in job order, so merging can read the jobs of all
+ * shards in order while holding a single job per shard.
+ */
+class Shard {
+   public:
+    /**
+     * Parse a shard given as "i/N" into its index and count
+     */
+    static std::pair<Uint, Uint> parse(std::string_view shardStr);
+
+    /**
+     * Get the jobs belonging to a shard in ascending order, every job when not sharding
+     */
+    static std::vector<Uint> getJobs(Uint numberOfJobs, Uint shard, Uint shardCount);
+
+    static void save(const Path &shardPath, const ShardHeader &header,
+                     const std::vector<ShardJob> &jobs, Uint timeElapsed);
+
+    /**
+     * Combine every shard of a sweep into the result files a single process would have written,
+     * one per branch when branching. Traces are streamed to the output as the jobs are read.
+     */
+    static void merge(const std::vector<Path> &shardPaths, const Path &outputPath);
+};
+}  // namespace palloc
+
+template <>
+struct glz::meta<palloc::ShardHeader> {
+    using T = palloc::ShardHeader;
+    static constexpr auto value =
+        glz::object("shard", &T::shard, "shard_count", &T::shardCount, "runs", &T::numberOfRuns,
+                    "branching", &T::branching, "branch_settings", &T::branchSettings);
+};
+
+template <>
+struct glz::meta<palloc::ShardJob> {
+    using T = palloc::ShardJob;
+    static constexpr auto value = glz::object("job", &T::job, "result", &T::result);
+};
+
+template <>
+struct glz::meta<palloc::ShardFooter> {
+    using T = palloc::ShardFooter;
+    static constexpr auto value = glz::object("time_elapsed", &T::timeElapsed);
+};
+
+#endif
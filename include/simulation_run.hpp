@@ -0,0 +1,120 @@
+#ifndef SIMULATION_RUN_HPP
+#define SIMULATION_RUN_HPP
+
+#include <generator>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+
+#include "checkpoint.hpp"
+#include "demand_forecast.hpp"
+#include "environment.hpp"
+#include "request_source.hpp"
+#include "run_sink.hpp"
+#include "scratch_arena.hpp"
+#include "settings.hpp"
+#include "simulator.hpp"
+#include "types.hpp"
+
+namespace palloc {
+/**
+ * Resources of a run's timestep loop which are not part of its checkpointed state
+ */
+struct RunResources {
+    explicit RunResources(const Environment &env, const SimulatorSettings &simSettings);
+
+    // Scratch memory of every batch in the run, reused once a batch is done
+    ScratchArena arena;
+    std::optional<DemandForecast> forecast;
+};
+
+/**
+ * Totals of a run up to and including the last simulated timestep
+ */
+struct RunMetrics {
+    Uint requestsGenerated;
+    size_t requestsScheduled;
+    size_t processedRequests;
+    size_t droppedRequests;
+    double totalCost;
+    Uint totalDuration;
+    size_t batches;
+    size_t fastPathBatches;
+
+    double getAverageCost() const noexcept {
+        return processedRequests == 0 ? 0.0 : totalCost / static_cast<double>(processedRequests);
+    }
+
+    double getAverageDuration() const noexcept {
+        return requestsScheduled == 0
+                   ? 0.0
+                   : static_cast<double>(totalDuration) / static_cast<double>(requestsScheduled);
+    }
+};
+
+/**
+ * A run at the end of a timestep. Spans and ranges view the state of the run and are only valid
+ * until it is stepped again.
+ */
+struct RunSnapshot {
+    Uint timestep;
+    Uint timeOfDay;
+    std::span<const Uint> availableParkingSpots;
+    const Simulations &simulations;
+    // The simulations started by the batch of this timestep, the last ones of simulations
+    std::ranges::subrange<Simulations::const_iterator> startedSimulations;
+    // Requests the batch of this timestep could not assign, including requests dropped by an
+    // earlier batch and dropped again, as counted by RunMetrics::droppedRequests. Requests
+    // dropped for the first time have getTimesDropped() == 1
+    std::span<const Request> droppedRequests;
+    // All zero when no batch was solved
+    BatchEvent batch;
+    size_t pendingRequests;
+    size_t earlyRequests;
+    RunMetrics metrics;
+};
+
+/**
+ * A single run which is advanced by its caller one timestep at a time, for embedding the
+ * simulator in other tools. Nothing is printed or written and no threads are started, so many
+ * runs can be interleaved on any executor. Runs are neither copied nor moved since snapshots
+ * view their state.
+ */
+class SimulationRun {
+   public:
+    explicit SimulationRun(Environment env, const SimulatorSettings &simSettings,
+                           Uint runNumber = 0);
+
+    SimulationRun(const SimulationRun &) = delete;
+    SimulationRun &operator=(const SimulationRun &) = delete;
+
+    /**
+     * Simulate the next timestep, throws once all timesteps of the settings are simulated
+     */
+    const RunSnapshot &step();
+
+    /**
+     * Step lazily until the run is finished or the caller stops pulling. The run must outlive
+     * the generator.
+     */
+    std::generator<const RunSnapshot &> steps();
+
+    bool isFinished() const noexcept;
+    Uint getTimestep() const noexcept;
+    RunMetrics getMetrics() const noexcept;
+    const Environment &getEnvironment() const noexcept;
+
+   private:
+    Environment _env;
+    SimulatorSettings _simSettings;
+    std::unique_ptr<RequestSource> _source;
+    RunState _state;
+    RunResources _resources;
+    double _totalCost{};
+
+    std::optional<RunSnapshot> _snapshot;
+};
+}  // namespace palloc
+
+#endif
@@ -3,11 +3,12 @@
 
 #include <filesystem>
 #include <list>
-#include <mutex>
+#include <vector>
 
 #include "environment.hpp"
 #include "glaze/glaze.hpp"
-#include "request_generator.hpp"
+#include "memory_account.hpp"
+#include "request_source.hpp"
 #include "result.hpp"
 #include "settings.hpp"
 #include "trace.hpp"
@@ -16,45 +17,66 @@
 namespace palloc {
 class Simulation {
    public:
+    explicit Simulation() {}
     explicit Simulation(Uint dropoffNode, Uint parkingNode, Uint requestDuration,
-                        Uint earlyTimeLeft, Uint routeDuration)
+                        Uint earlyTimeLeft, Uint routeDuration, Uint requestId = 0,
+                        bool pendingClaim = false)
         : _dropoffNode(dropoffNode),
           _parkingNode(parkingNode),
           _requestDuration(requestDuration),
           _durationLeft(requestDuration),
           _earlyTimeLeft(earlyTimeLeft),
-          _routeDuration(routeDuration) {}
+          _routeDuration(routeDuration),
+          _requestId(requestId),
+          _pendingClaim(pendingClaim) {}
 
     Uint getDropoffNode() const noexcept;
     Uint getParkingNode() const noexcept;
     Uint getRequestDuration() const noexcept;
     Uint getDurationLeft() const noexcept;
+    Uint getEarlyTimeLeft() const noexcept;
     Uint getRouteDuration() const noexcept;
+    Uint getRequestId() const noexcept;
 
     bool isInDropoff() const noexcept;
     bool hasVisitedParking() const noexcept;
     bool isEarly() const noexcept;
     bool isDead() const noexcept;
 
+    /**
+     * Whether the spot is only claimed once the vehicle arrives instead of on assignment
+     */
+    bool hasPendingClaim() const noexcept;
+
     void setIsInDropoff(bool inDropoff) noexcept;
     void setHasVisitedParking(bool visitedParking) noexcept;
+    void setHasPendingClaim(bool pendingClaim) noexcept;
 
     void decrementDuration() noexcept;
     void decrementEarlyArrival() noexcept;
 
    private:
-    Uint _dropoffNode;
-    Uint _parkingNode;
-    Uint _requestDuration;
-    Uint _durationLeft;
-    Uint _earlyTimeLeft;
-    Uint _routeDuration;
+    friend struct glz::meta<Simulation>;
+
+    Uint _dropoffNode{};
+    Uint _parkingNode{};
+    Uint _requestDuration{};
+    Uint _durationLeft{};
+    Uint _earlyTimeLeft{};
+    Uint _routeDuration{};
+    Uint _requestId{};
 
     bool _inDropoff{true};
     bool _visitedParking{false};
+    bool _pendingClaim{false};
 };
 
-using Simulations = std::list<Simulation>;
+using Simulations =
+    std::list<Simulation, CountingAllocator<Simulation, MemoryCategory::SIMULATIONS>>;
+
+struct RunState;      // forward
+struct RunResources;  // forward
+struct BatchEvent;    // forward
 
 class Simulator {
    public:
@@ -62,18 +84,76 @@ class Simulator {
                          const OutputSettings &outputSettings,
                          const GeneralSettings &generalSettings);
 
-   private:
-    static void simulateRun(Environment env, const SimulatorSettings &simSettings,
-                            const OutputSettings &outputSettings, Results &results,
-                            std::mutex &resultsMutex, Uint runNumber);
+    /**
+     * Simulate the first warmupTimesteps of every run once with the given settings and fork the
+     * resulting state into one branch per entry of branchSettings. Each branch writes its own
+     * aggregated result.
+     */
+    static void simulateBranches(Environment &env, const SimulatorSettings &simSettings,
+                                 const std::vector<SimulatorSettings> &branchSettings,
+                                 const OutputSettings &outputSettings,
+                                 const GeneralSettings &generalSettings);
 
     static void updateSimulations(Simulations &simulations, Environment &env);
-    static void insertNewRequests(RequestGenerator &generator, Uint currentTimeOfDay,
+    static void insertNewRequests(RequestSource &source, Uint currentTimeOfDay,
                                   Requests &requests);
     static void removeDeadRequests(Requests &unassignedRequests);
     static void decrementArrivalTime(Requests &earlyRequests);
     static void cutImpossibleRequests(Requests &requests, const UintVector &smallestRoundTrips);
+
+    /**
+     * Without a batch size a batch is solved every batch interval minutes. With one a batch is
+     * solved once that many new requests are pending, the oldest new request has waited the
+     * batch interval, an early request enters its commit window or a dropped request is about
+     * to become impossible to serve.
+     */
+    static bool isBatchingStep(const RunState &state, const SimulatorSettings &simSettings,
+                               const UintVector &smallestRoundTrips, Uint timestep);
+
+   private:
+    friend class SimulationRun;
+
+    static Result simulateRun(Environment env, const SimulatorSettings &simSettings,
+                              const OutputSettings &outputSettings, Uint runNumber,
+                              bool pipelined);
+
+    /**
+     * Advance a run until lastTimestep, checkpointing to checkpointPath if it is not empty. When
+     * pipelined and not checkpointing, requests are generated ahead and traces are built on
+     * their own threads.
+     */
+    static void advanceRun(RunState &state, Environment &env, RequestSource &source,
+                           const SimulatorSettings &simSettings,
+                           const OutputSettings &outputSettings, Uint lastTimestep,
+                           const Path &checkpointPath, bool pipelined = false);
+
+    /**
+     * Copy the live state of a warm-up prefix into a new branch. Costs and traces of the prefix
+     * are not copied and are only joined with the branch history once the branch finishes.
+     */
+    static RunState forkRun(const RunState &prefix, const SimulatorSettings &simSettings);
+
+    /**
+     * Simulate the timestep after state.timestep without traces, reports or checkpoints and
+     * return its batch, which is all zero when none was solved
+     */
+    static BatchEvent stepRun(RunState &state, Environment &env, RequestSource &source,
+                              const SimulatorSettings &simSettings, RunResources &resources);
+
+    static Result createResult(RunState &state, const RequestSource &source,
+                               const RunState *prefix = nullptr);
 };
 }  // namespace palloc
 
+template <>
+struct glz::meta<palloc::Simulation> {
+    using T = palloc::Simulation;
+    static constexpr auto value = glz::object(
+        "dropoff", &T::_dropoffNode, "parking", &T::_parkingNode, "request_duration",
+        &T::_requestDuration, "duration_left", &T::_durationLeft, "early_time_left",
+        &T::_earlyTimeLeft, "route_duration", &T::_routeDuration, "request_id", &T::_requestId,
+        "in_dropoff", &T::_inDropoff, "visited_parking", &T::_visitedParking, "pending_claim",
+        &T::_pendingClaim);
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef SPATIAL_INDEX_HPP
+#define SPATIAL_INDEX_HPP
+
+#include <memory_resource>
+#include <vector>
+
+#include "types.hpp"
+
+namespace palloc {
+/**
+ * Planar position in meters
+ */
+struct Point {
+    double x;
+    double y;
+};
+
+/**
+ * Uniform grid over a set of points answering which points lie within a radius of a position
+ */
+class SpatialIndex {
+   public:
+    using Indices = std::pmr::vector<Uint>;
+
+    explicit SpatialIndex() {}
+    explicit SpatialIndex(const std::vector<Point> &points);
+
+    /**
+     * Get the indices of all points within radius of center in ascending order
+     *
+     * @param result reused buffer which is overwritten with the indices
+     */
+    void query(const Point &center, double radius, Indices &result) const;
+
+    size_t size() const noexcept;
+
+    /**
+     * Heap bytes held by the grid
+     */
+    size_t getOwnedBytes() const noexcept;
+
+   private:
+    size_t getCell(double position, double min, double cellSize, size_t cells) const noexcept;
+
+    std::vector<Point> _points;
+    UintVector _cellStart;
+    UintVector _cellPoints;
+    double _minX{};
+    double _minY{};
+    double _cellWidth{1.0};
+    double _cellHeight{1.0};
+    size_t _columns{};
+    size_t _rows{};
+
+    static constexpr double POINTS_PER_CELL = 4.0;
+};
+}  // namespace palloc
+
+#endif
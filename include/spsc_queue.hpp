@@ -0,0 +1,94 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace palloc {
+/**
+ * Bounded lock-free queue between exactly one producer and one consumer thread. Both sides wait
+ * on the index of the other instead of spinning. Closing the queue wakes both sides, pushes fail
+ * from then on and pops return what is left before failing.
+ */
+template <typename T>
+class SpscQueue {
+   public:
+    explicit SpscQueue(size_t capacity) : _slots(capacity) { assert(capacity > 0); }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+     * Wait for a free slot and add the value, false if the queue is closed
+     */
+    bool push(T value) {
+        const auto tail = _tail.load(std::memory_order_relaxed);
+        for (;;) {
+            const auto head = _head.load(std::memory_order_acquire);
+            if (((head | tail) & CLOSED) != 0) {
+                return false;
+            }
+
+            if (tail - head < _slots.size()) {
+                break;
+            }
+
+            _head.wait(head, std::memory_order_acquire);
+        }
+
+        _slots[tail % _slots.size()] = std::move(value);
+        _tail.fetch_add(1, std::memory_order_release);
+        _tail.notify_one();
+        return true;
+    }
+
+    /**
+     * Wait for a value and take it, empty once the queue is closed and drained
+     */
+    std::optional<T> pop() {
+        const auto head = _head.load(std::memory_order_relaxed) & ~CLOSED;
+        for (;;) {
+            const auto tail = _tail.load(std::memory_order_acquire);
+            if ((tail & ~CLOSED) != head) {
+                break;
+            }
+
+            if ((tail & CLOSED) != 0) {
+                return std::nullopt;
+            }
+
+            _tail.wait(tail, std::memory_order_acquire);
+        }
+
+        std::optional<T> value(std::move(_slots[head % _slots.size()]));
+        _head.fetch_add(1, std::memory_order_release);
+        _head.notify_one();
+        return value;
+    }
+
+    /**
+     * Close the queue from either side
+     */
+    void close() {
+        _tail.fetch_or(CLOSED);
+        _tail.notify_all();
+        _head.fetch_or(CLOSED);
+        _head.notify_all();
+    }
+
+   private:
+    // Set in both indices once closed, so waiting on an index also wakes up on closing
+    static constexpr size_t CLOSED = size_t{1} << (sizeof(size_t) * 8 - 1);
+
+    std::vector<T> _slots;
+
+    // Separate cache lines, the producer writes the tail and the consumer the head
+    alignas(64) std::atomic<size_t> _head{0};
+    alignas(64) std::atomic<size_t> _tail{0};
+};
+}  // namespace palloc
+
+#endif
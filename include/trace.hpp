@@ -7,6 +7,7 @@
 #include "assignment.hpp"
 #include "environment.hpp"
 #include "glaze/glaze.hpp"
+#include "memory_account.hpp"
 #include "types.hpp"
 
 namespace palloc {
@@ -16,7 +17,8 @@ class Trace {
     explicit Trace(Assignments assignments, size_t numberOfRequests,
                    size_t numberOfOngoingSimulations, Uint availableParkingSpots,
                    size_t droppedRequests, size_t earlyRequests, Uint timestep,
-                   Uint currentTimeOfDay, double cost, double averageDuration, Uint variableCount)
+                   Uint currentTimeOfDay, double cost, double averageDuration, size_t variableCount,
+                   bool usedFastPath, size_t batchSize, Uint batchLatency)
         : _assignments(std::move(assignments)),
           _numberOfRequests(numberOfRequests),
           _numberOfOngoingSimulations(numberOfOngoingSimulations),
@@ -27,7 +29,10 @@ class Trace {
           _currentTimeOfDay(currentTimeOfDay),
           _averageCost(cost),
           _averageDuration(averageDuration),
-          _variableCount(variableCount) {}
+          _variableCount(variableCount),
+          _usedFastPath(usedFastPath),
+          _batchSize(batchSize),
+          _batchLatency(batchLatency) {}
 
     size_t getNumberOfOngoingSimulations() const noexcept;
     size_t getDroppedRequests() const noexcept;
@@ -38,11 +43,18 @@ class Trace {
 
     Uint getTimeStep() const noexcept;
 
+    bool hasUsedFastPath() const noexcept;
+
+    size_t getBatchSize() const noexcept;
+    Uint getBatchLatency() const noexcept;
+
     double getAverageCost() const noexcept;
     double getAverageDuration() const noexcept;
 
     Assignments getAssignments() const noexcept;
 
+    void setAssignments(Assignments assignments) noexcept;
+
    private:
     friend struct glz::meta<Trace>;
 
@@ -60,10 +72,16 @@ class Trace {
     double _averageCost{};
     double _averageDuration{};
 
-    Uint _variableCount{};
+    size_t _variableCount{};
+
+    bool _usedFastPath{};
+
+    // Requests solved in this timestep and how long the oldest new one among them waited
+    size_t _batchSize{};
+    Uint _batchLatency{};
 };
 
-using TraceList = std::list<Trace>;
+using TraceList = std::list<Trace, CountingAllocator<Trace, MemoryCategory::TRACES>>;
 using TraceLists = std::vector<TraceList>;
 }  // namespace palloc
 
@@ -76,7 +94,9 @@ struct glz::meta<palloc::Trace> {
         &T::_numberOfOngoingSimulations, "available_parking_spots", &T::_availableParkingSpots,
         "average_cost", &T::_averageCost, "average_duration", &T::_averageDuration, "var_count",
         &T::_variableCount, "dropped_requests", &T::_droppedRequests, "early_requests",
-        &T::_earlyRequests, "variable_count", &T::_variableCount, "assignments", &T::_assignments);
+        &T::_earlyRequests, "variable_count", &T::_variableCount, "fast_path",
+        &T::_usedFastPath, "batch_size", &T::_batchSize, "batch_latency", &T::_batchLatency,
+        "assignments", &T::_assignments);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,124 @@
+#ifndef TRAVEL_TIMES_HPP
+#define TRAVEL_TIMES_HPP
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "settings.hpp"
+#include "types.hpp"
+
+namespace palloc {
+/**
+ * Travel times between dropoffs and parkings stored per dropoff in compressed sparse rows. A dense
+ * environment keeps every parking in every row, while a cutoff or nearest limit drops pairs which
+ * can never be worth driving. Pairs that are not stored are unreachable.
+ */
+class TravelTimes {
+   public:
+    using Duration = std::uint16_t;
+
+    // Smallest round trip of a dropoff without any stored parking, longer than any request
+    static constexpr Uint UNREACHABLE = std::numeric_limits<Uint>::max();
+
+    /**
+     * The parkings kept for one dropoff in ascending order along with both legs of the trip
+     */
+    struct Row {
+        std::span<const Uint> parkings;
+        std::span<const Duration> toParking;
+        std::span<const Duration> toDropoff;
+        // Position of the first entry of the row among all entries
+        size_t offset;
+
+        std::optional<size_t> find(Uint parkingNode) const noexcept;
+        Uint getRoundTrip(size_t entry) const noexcept;
+    };
+
+    explicit TravelTimes() {}
+
+    Row getRow(Uint dropoffNode) const noexcept;
+
+    /**
+     * Lookups of a single pair, which must be stored
+     */
+    Uint getDropoffToParking(Uint dropoffNode, Uint parkingNode) const noexcept;
+    Uint getParkingToDropoff(Uint parkingNode, Uint dropoffNode) const noexcept;
+    Uint getRoundTrip(Uint dropoffNode, Uint parkingNode) const noexcept;
+
+    /**
+     * Get the shortest stored round trip of every dropoff, or UNREACHABLE for empty rows
+     */
+    UintVector getSmallestRoundTrips() const;
+
+    size_t getNumberOfDropoffs() const noexcept;
+    size_t getNumberOfParkings() const noexcept;
+    size_t getNumberOfEntries() const noexcept;
+
+   private:
+    size_t getEntry(Uint dropoffNode, Uint parkingNode) const noexcept;
+
+    friend class TravelTimesBuilder;
+
+    size_t _numberOfDropoffs{};
+    size_t _numberOfParkings{};
+    std::vector<size_t> _rowStart;
+    UintVector _parkings;
+    std::vector<Duration> _toParking;
+    std::vector<Duration> _toDropoff;
+};
+
+/**
+ * Builds travel times one matrix row at a time so loaders never hold a dense matrix. Rows of the
+ * dropoff to parking matrix select the pairs to keep, rows of the parking to dropoff matrix only
+ * fill in the return leg of those pairs and are held back until all dropoff rows are known.
+ */
+class TravelTimesBuilder {
+   public:
+    explicit TravelTimesBuilder(const StorageSettings &storageSettings);
+
+    /**
+     * Add the durations from the next dropoff to every parking
+     */
+    void addDropoffRow(std::span<const Uint> durations);
+
+    /**
+     * Mark the dropoff rows as complete, which fixes the number of dropoffs
+     */
+    void endDropoffRows();
+
+    /**
+     * Add the durations from the next parking to every dropoff
+     */
+    void addParkingRow(std::span<const Uint> durations);
+
+    TravelTimes build();
+
+    size_t getNumberOfDropoffRows() const noexcept;
+    size_t getNumberOfParkingRows() const noexcept;
+
+   private:
+    struct Entry {
+        Uint parkingNode;
+        TravelTimes::Duration toParking;
+        TravelTimes::Duration toDropoff;
+    };
+
+    void applyParkingRow(Uint parkingNode, std::span<const Uint> durations);
+    bool isKept(Uint duration) const noexcept;
+
+    StorageSettings _storageSettings;
+    std::optional<size_t> _numberOfParkings;
+    std::vector<std::vector<Entry>> _rows;
+    bool _dropoffRowsEnded{};
+    size_t _parkingRowsAdded{};
+    std::vector<UintVector> _pendingParkingRows;
+
+    // Durations which do not fit the compressed storage are treated as unreachable
+    static constexpr Uint MISSING = std::numeric_limits<TravelTimes::Duration>::max();
+};
+}  // namespace palloc
+
+#endif
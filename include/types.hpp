@@ -9,6 +9,7 @@ namespace palloc {
 using Uint = uint32_t;
 using Uint64 = uint64_t;
 using Int = int32_t;
+using Int64 = int64_t;
 using UintVector = std::vector<Uint>;
 using DoubleVector = std::vector<double>;
 using Path = std::filesystem::path;
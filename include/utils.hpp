@@ -3,6 +3,9 @@
 
 #include <concepts>
 #include <ranges>
+#include <string>
+
+#include "types.hpp"
 
 namespace palloc::utils {
 /**
@@ -25,6 +28,42 @@ auto KahanSum(const Range &values) {
 
     return sum;
 }
+
+/**
+ * Get the path of a per-run file. Runs get their own file when more than one is aggregated.
+ * @param path The path given by the user.
+ * @param runNumber The run the file belongs to.
+ * @param numberOfRuns The number of runs being aggregated.
+ **/
+inline Path getRunPath(const Path &path, Uint runNumber, Uint numberOfRuns) {
+    if (numberOfRuns <= 1) {
+        return path;
+    }
+
+    Path runPath = path;
+    runPath.replace_filename(path.stem().string() + "_" + std::to_string(runNumber) +
+                             path.extension().string());
+    return runPath;
+}
+
+/**
+ * Get the path of the file belonging to a branch forked from a shared warm-up.
+ * @param path The path given by the user.
+ * @param branch The index of the branch.
+ **/
+inline Path getBranchPath(const Path &path, Uint branch) {
+    Path branchPath = path;
+    branchPath.replace_filename(path.stem().string() + "_branch" + std::to_string(branch) +
+                                path.extension().string());
+    return branchPath;
+}
+
+/**
+ * Get the minute of the day a timestep of a run simulates, timestep 1 being the start time.
+ **/
+inline Uint getTimeOfDay(Uint startTime, Uint timestep) {
+    return (startTime + timestep - 1) % 1440;
+}
 }  // namespace palloc::utils
 
 #endif
\ No newline at end of file
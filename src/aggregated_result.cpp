@@ -4,51 +4,85 @@
 
 using namespace palloc;
 
-AggregatedResult::AggregatedResult(const Results &results) {
-    TraceLists traceLists;
-    traceLists.reserve(results.size());
+void RunTotals::add(const Result &result) {
+    const auto &report = result.getReport();
+    const auto &memory = result.getMemory();
+    if (_durationVec.empty()) {
+        _simSettings = result.getSimSettings();
+        if (report) {
+            _report.emplace();
+        }
+
+        if (memory) {
+            _memory.emplace();
+        }
+    }
+
+    if (!report) {
+        _report.reset();
+    } else if (_report) {
+        _report->add(*report);
+    }
 
-    SimulatorSettings simSettings = results[0].getSimSettings();
-    size_t totalRunVariables = 0;
-    size_t droppedRequests = 0;
-    Uint requestsGenerated = 0;
-    size_t requestsScheduled = 0;
-    size_t requestsUnassigned = 0;
-    size_t processedRequests = 0;
+    if (!memory) {
+        _memory.reset();
+    } else if (_memory) {
+        _memory->push_back(*memory);
+    }
 
-    DoubleVector durationVec;
-    durationVec.reserve(results.size());
+    _durationVec.push_back(result.getTotalDuration());
+    _costVec.push_back(result.getTotalCost());
+    _totalRunVariables += result.getTotalRunVariables();
+    _droppedRequests += result.getDroppedRequests();
+    _requestsGenerated += result.getRequestsGenerated();
+    _requestsScheduled += result.getRequestsScheduled();
+    _requestsUnassigned += result.getRequestsUnassigned();
+    _processedRequests += result.getProcessedRequests();
+    _batches += result.getBatches();
+    _fastPathBatches += result.getFastPathBatches();
+}
 
-    DoubleVector costVec;
-    costVec.reserve(results.size());
+static RunTotals getRunTotals(const Results &results) {
+    RunTotals totals;
+    for (const Result &result : results) {
+        totals.add(result);
+    }
+
+    return totals;
+}
+
+static TraceLists collectTraceLists(const Results &results) {
+    TraceLists traceLists;
+    traceLists.reserve(results.size());
     for (const Result &result : results) {
         traceLists.push_back(result.getTraceList());
-        durationVec.push_back(result.getTotalDuration());
-        costVec.push_back(result.getTotalCost());
-        totalRunVariables += result.getTotalRunVariables();
-        droppedRequests += result.getDroppedRequests();
-        requestsGenerated += result.getRequestsGenerated();
-        requestsScheduled += result.getRequestsScheduled();
-        requestsUnassigned += result.getRequestsUnassigned();
-        processedRequests += result.getProcessedRequests();
     }
 
-    auto avgDuration = utils::KahanSum(durationVec);
-    auto avgCost = utils::KahanSum(costVec);
-    if (requestsScheduled == 0) {
+    return traceLists;
+}
+
+AggregatedResult::AggregatedResult(const Results &results)
+    : AggregatedResult(getRunTotals(results), collectTraceLists(results)) {}
+
+AggregatedResult::AggregatedResult(const RunTotals &totals, TraceLists traceLists) {
+    assert(!totals._durationVec.empty());
+
+    auto avgDuration = utils::KahanSum(totals._durationVec);
+    auto avgCost = utils::KahanSum(totals._costVec);
+    if (totals._requestsScheduled == 0) {
         avgDuration = 0.0;
     } else {
-        avgDuration /= static_cast<double>(requestsScheduled);
+        avgDuration /= static_cast<double>(totals._requestsScheduled);
     }
 
-    if (processedRequests == 0) {
+    if (totals._processedRequests == 0) {
         avgCost = 0.0;
     } else {
-        avgCost /= static_cast<double>(processedRequests);
+        avgCost /= static_cast<double>(totals._processedRequests);
     }
 
-    const Uint timesteps = simSettings.timesteps;
-    const Uint batchInterval = simSettings.batchInterval;
+    const Uint timesteps = totals._simSettings.timesteps;
+    const Uint batchInterval = totals._simSettings.batchInterval;
 
     Uint totalSteps = timesteps / batchInterval;
     if (timesteps % batchInterval != 0) {
@@ -56,18 +90,27 @@ AggregatedResult::AggregatedResult(const Results &results) {
     }
 
     auto avgVariableCount =
-        static_cast<double>(totalRunVariables) / static_cast<double>(totalSteps);
+        static_cast<double>(totals._totalRunVariables) / static_cast<double>(totalSteps);
 
-    _traceLists = traceLists;
-    _simSettings = simSettings;
-    _droppedRequests = droppedRequests;
+    _traceLists = std::move(traceLists);
+    _simSettings = totals._simSettings;
+    _droppedRequests = totals._droppedRequests;
     _avgDuration = avgDuration;
     _avgCost = avgCost;
     _avgVariableCount = avgVariableCount;
-    _requestsGenerated = requestsGenerated;
-    _requestsScheduled = requestsScheduled;
-    _requestsUnassigned = requestsUnassigned;
-    _processedRequests = processedRequests;
+    _requestsGenerated = totals._requestsGenerated;
+    _requestsScheduled = totals._requestsScheduled;
+    _requestsUnassigned = totals._requestsUnassigned;
+    _processedRequests = totals._processedRequests;
+    _batches = totals._batches;
+    _fastPathBatches = totals._fastPathBatches;
+    if (totals._report) {
+        _report = totals._report->build();
+    }
+
+    if (totals._memory) {
+        _memory = MemoryReport{.runs = *totals._memory, .phases = {}};
+    }
 }
 
 AggregatedResult::AggregatedResult(const Path &inputPath) { loadResult(inputPath); }
@@ -86,6 +129,24 @@ size_t AggregatedResult::getTotalRequestsGenerated() const noexcept { return _re
 
 size_t AggregatedResult::getTotalRequestsScheduled() const noexcept { return _requestsScheduled; }
 
+size_t AggregatedResult::getTotalBatches() const noexcept { return _batches; }
+
+size_t AggregatedResult::getTotalFastPathBatches() const noexcept { return _fastPathBatches; }
+
+const std::optional<ReportAggregates> &AggregatedResult::getReport() const noexcept {
+    return _report;
+}
+
+const std::optional<MemoryReport> &AggregatedResult::getMemory() const noexcept {
+    return _memory;
+}
+
+void AggregatedResult::addMemoryPhase(PhaseMemory phase) {
+    if (_memory) {
+        _memory->phases.push_back(std::move(phase));
+    }
+}
+
 void AggregatedResult::setTimeElapsed(Uint timeElapsed) noexcept { _timeElapsed = timeElapsed; }
 
 void AggregatedResult::saveToFile(const Path &outputPath, bool prettify) const {
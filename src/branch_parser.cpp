@@ -0,0 +1,97 @@
+#include "branch_parser.hpp"
+
+#include <charconv>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+
+#include "scheduler.hpp"
+
+using namespace palloc;
+
+static std::string_view trim(std::string_view str) {
+    const auto first = str.find_first_not_of(" \t");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+
+    const auto last = str.find_last_not_of(" \t");
+    return str.substr(first, last - first + 1);
+}
+
+std::vector<SimulatorSettings> BranchParser::parse(std::string_view branchesStr,
+                                                   const SimulatorSettings &baseSettings) {
+    std::vector<SimulatorSettings> branches;
+    for (const auto branchRange : std::views::split(branchesStr, ';')) {
+        SimulatorSettings settings = baseSettings;
+        for (const auto overrideRange : std::views::split(branchRange, ',')) {
+            const auto overrideStr = trim(std::string_view(overrideRange));
+            if (!overrideStr.empty()) {
+                applyOverride(overrideStr, settings);
+            }
+        }
+
+        branches.push_back(settings);
+    }
+
+    return branches;
+}
+
+void BranchParser::applyOverride(std::string_view overrideStr, SimulatorSettings &settings) {
+    const auto separator = overrideStr.find('=');
+    if (separator == std::string_view::npos) {
+        throw std::invalid_argument("Expected key=value in branch override: " +
+                                    std::string(overrideStr));
+    }
+
+    const auto key = trim(overrideStr.substr(0, separator));
+    const auto value = trim(overrideStr.substr(separator + 1));
+    if (key == "batch-interval") {
+        settings.batchInterval = parseUint(key, value);
+        if (settings.batchInterval < 1) {
+            throw std::invalid_argument("Branch batch interval must be a natural number");
+        }
+    } else if (key == "commit-interval") {
+        settings.commitInterval = parseUint(key, value);
+    } else if (key == "minimum-parking-time") {
+        settings.minParkingTime = parseUint(key, value);
+    } else if (key == "batch-size") {
+        settings.batchSize = parseUint(key, value);
+    } else if (key == "scheduler") {
+        if (!Scheduler::availableBackends.contains(std::string(value))) {
+            throw std::invalid_argument("Unknown branch scheduler backend: " + std::string(value));
+        }
+
+        settings.schedulerBackend = value;
+    } else if (key == "horizon") {
+        settings.horizon = parseUint(key, value);
+    } else if (key == "weighted-parking") {
+        settings.useWeightedParking = parseBool(key, value);
+    } else {
+        throw std::invalid_argument("Unknown branch setting: " + std::string(key));
+    }
+}
+
+Uint BranchParser::parseUint(std::string_view key, std::string_view value) {
+    Uint result = 0;
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (error != std::errc{} || end != value.data() + value.size()) {
+        throw std::invalid_argument("Expected a non-negative integer for branch setting " +
+                                    std::string(key) + ", got: " + std::string(value));
+    }
+
+    return result;
+}
+
+bool BranchParser::parseBool(std::string_view key, std::string_view value) {
+    if (value == "true" || value == "1") {
+        return true;
+    }
+
+    if (value == "false" || value == "0") {
+        return false;
+    }
+
+    throw std::invalid_argument("Expected true or false for branch setting " + std::string(key) +
+                                ", got: " + std::string(value));
+}
@@ -0,0 +1,55 @@
+#include "checkpoint.hpp"
+
+#include <stdexcept>
+#include <string>
+
+using namespace palloc;
+
+void Checkpoint::save(const RunState &state, const Path &checkpointPath) {
+    // Write next to the old snapshot and rename so a crash never leaves a torn checkpoint
+    Path tempPath = checkpointPath;
+    tempPath += ".tmp";
+
+    const auto error = glz::write_file_beve(state, tempPath.string(), std::string{});
+    if (error) {
+        const auto errorStr = glz::format_error(error, std::string{});
+        throw std::runtime_error("Failed to write checkpoint: " + tempPath.string() +
+                                 "\nwith error: " + errorStr);
+    }
+
+    std::filesystem::rename(tempPath, checkpointPath);
+}
+
+RunState Checkpoint::load(const Path &checkpointPath, const SimulatorSettings &simSettings,
+                          Uint runNumber) {
+    if (!std::filesystem::exists(checkpointPath)) {
+        throw std::runtime_error("Checkpoint file does not exist: " + checkpointPath.string());
+    }
+
+    RunState state;
+    const auto error = glz::read_file_beve(state, checkpointPath.string(), std::string{});
+    if (error) {
+        const auto errorStr = glz::format_error(error, std::string{});
+        throw std::runtime_error("Failed to read checkpoint: " + checkpointPath.string() +
+                                 "\nwith error: " + errorStr);
+    }
+
+    // Only the number of timesteps may change, which allows extending a run. Checkpoints are
+    // never taken after the batch forced at the last timestep, so the extension matches a run
+    // simulated with the longer horizon from the start
+    SimulatorSettings checkpointSettings = state.simSettings;
+    checkpointSettings.timesteps = simSettings.timesteps;
+    if (state.runNumber != runNumber || checkpointSettings != simSettings) {
+        throw std::runtime_error("Checkpoint was created with different settings: " +
+                                 checkpointPath.string());
+    }
+
+    // At least the last timestep has to be simulated to solve the requests still pending
+    if (state.timestep >= simSettings.timesteps) {
+        throw std::runtime_error("Checkpoint is not before the last timestep: " +
+                                 checkpointPath.string());
+    }
+
+    state.simSettings = simSettings;
+    return state;
+}
@@ -0,0 +1,72 @@
+#include "demand_forecast.hpp"
+
+#include <cmath>
+
+#include "request_generator.hpp"
+
+using namespace palloc;
+
+DemandForecast::DemandForecast(const Environment &env, const SimulatorSettings &simSettings)
+    : _travelTimes(env.getTravelTimes()),
+      _preferringDropoffs(env.getNumberOfParkings(), 0),
+      _requestsPerDropoff(simSettings.requestRate / static_cast<double>(env.getNumberOfDropoffs())),
+      _horizon(simSettings.horizon) {
+    for (Uint dropoffNode = 0; dropoffNode < env.getNumberOfDropoffs(); ++dropoffNode) {
+        const auto row = _travelTimes->getRow(dropoffNode);
+        if (row.parkings.empty()) {
+            continue;
+        }
+
+        size_t preferred = 0;
+        Int64 preferredCost = env.getCost(row, 0, simSettings.useWeightedParking);
+        for (size_t k = 1; k < row.parkings.size(); ++k) {
+            const auto cost = env.getCost(row, k, simSettings.useWeightedParking);
+            if (cost < preferredCost) {
+                preferred = k;
+                preferredCost = cost;
+            }
+        }
+
+        ++_preferringDropoffs[row.parkings[preferred]];
+    }
+}
+
+UintVector DemandForecast::getReservations(Uint currentTimeOfDay,
+                                           const Simulations &simulations) const {
+    const auto numberOfParkings = _preferringDropoffs.size();
+
+    double expectedRequests = 0.0;
+    for (Uint minute = 1; minute <= _horizon; ++minute) {
+        expectedRequests += RequestGenerator::getTimeMultiplier((currentTimeOfDay + minute) % 1440);
+    }
+
+    expectedRequests *= _requestsPerDropoff;
+
+    UintVector releases(numberOfParkings, 0);
+    for (const auto &simulation : simulations) {
+        // Already driven back from the parking
+        if (simulation.isInDropoff() && simulation.hasVisitedParking()) {
+            continue;
+        }
+
+        const auto parkingNode = simulation.getParkingNode();
+        const auto timeToDrive =
+            _travelTimes->getParkingToDropoff(parkingNode, simulation.getDropoffNode());
+        const auto durationLeft = simulation.getDurationLeft();
+        const Uint untilRelease = simulation.getEarlyTimeLeft() +
+                                  (durationLeft > timeToDrive ? durationLeft - timeToDrive : 0);
+        if (untilRelease <= _horizon) {
+            ++releases[parkingNode];
+        }
+    }
+
+    UintVector reservations(numberOfParkings, 0);
+    for (size_t j = 0; j < numberOfParkings; ++j) {
+        const auto demand = std::lround(expectedRequests * _preferringDropoffs[j]);
+        if (demand > releases[j]) {
+            reservations[j] = static_cast<Uint>(demand - releases[j]);
+        }
+    }
+
+    return reservations;
+}
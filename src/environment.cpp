@@ -1,22 +1,76 @@
 #include "environment.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+
+#include "environment_loader.hpp"
+
 using namespace palloc;
 
-Environment::Environment(const Path &environmentPath) { loadEnvironment(environmentPath); }
+Environment::Environment(const Path &environmentPath, const StorageSettings &storageSettings) {
+    loadEnvironment(environmentPath, storageSettings);
+}
+
+Environment::Environment(EnvironmentData data) { initialize(std::move(data)); }
+
+const std::shared_ptr<const TravelTimes> &Environment::getTravelTimes() const noexcept {
+    return _travelTimes;
+}
+
+Uint Environment::getDropoffToParking(Uint dropoffNode, Uint parkingNode) const noexcept {
+    return _travelTimes->getDropoffToParking(dropoffNode, parkingNode);
+}
+
+Uint Environment::getParkingToDropoff(Uint parkingNode, Uint dropoffNode) const noexcept {
+    return _travelTimes->getParkingToDropoff(parkingNode, dropoffNode);
+}
+
+Uint Environment::getRoundTrip(Uint dropoffNode, Uint parkingNode) const noexcept {
+    return _travelTimes->getRoundTrip(dropoffNode, parkingNode);
+}
+
+Int64 Environment::getCost(const TravelTimes::Row &row, size_t entry,
+                           bool useWeightedParking) const noexcept {
+    if (useWeightedParking) {
+        assert(_weightedCosts);
+        return (*_weightedCosts)[row.offset + entry];
+    }
 
-const Environment::DurationMatrix &Environment::getDropoffToParking() const noexcept {
-    return _dropoffToParking;
+    return row.getRoundTrip(entry);
 }
 
-const Environment::DurationMatrix &Environment::getParkingToDropoff() const noexcept {
-    return _parkingToDropoff;
+bool Environment::canPruneParkings() const noexcept { return _parkingIndex != nullptr; }
+
+void Environment::getReachableParkings(Uint dropoffNode, Uint roundTripBudget,
+                                       SpatialIndex::Indices &parkings) const {
+    if (!canPruneParkings()) {
+        const auto row = _travelTimes->getRow(dropoffNode);
+        parkings.assign(row.parkings.begin(), row.parkings.end());
+        return;
+    }
+
+    // A feasible round trip covers twice the straight-line distance at no more than max speed.
+    // The tolerance keeps parkings exactly on the boundary despite rounding
+    const double radius = _maxSpeed * roundTripBudget / 2.0 * (1.0 + 1e-9);
+    _parkingIndex->query((*_projectedDropoffs)[dropoffNode], radius, parkings);
 }
 
 UintVector &Environment::getAvailableParkingSpots() noexcept { return _availableParkingSpots; }
 
-size_t Environment::getNumberOfDropoffs() const noexcept { return _dropoffToParking.size(); }
+const UintVector &Environment::getAvailableParkingSpots() const noexcept {
+    return _availableParkingSpots;
+}
+
+size_t Environment::getNumberOfDropoffs() const noexcept {
+    return _travelTimes->getNumberOfDropoffs();
+}
 
-size_t Environment::getNumberOfParkings() const noexcept { return _parkingToDropoff.size(); }
+size_t Environment::getNumberOfParkings() const noexcept {
+    return _travelTimes->getNumberOfParkings();
+}
 
 const Environment::Coordinates &Environment::getDropoffCoordinates() const noexcept {
     return _dropoffCoords;
@@ -32,16 +86,114 @@ const UintVector &Environment::getSmallestRoundTrips() const noexcept {
 
 const DoubleVector &Environment::getParkingWeights() const noexcept { return _parkingWeights; }
 
-void Environment::loadEnvironment(const Path &environmentPath) {
-    if (!std::filesystem::exists(environmentPath)) {
-        throw std::runtime_error("Environment file does not exist: " + environmentPath.string());
+const LoadStatistics &Environment::getLoadStatistics() const noexcept { return _loadStatistics; }
+
+size_t Environment::getCopiedBytes() const noexcept {
+    return (_availableParkingSpots.capacity() + _smallestRoundTrips.capacity()) * sizeof(Uint) +
+           _parkingWeights.capacity() * sizeof(double) +
+           (_dropoffCoords.capacity() + _parkingCoords.capacity()) * sizeof(Coordinate);
+}
+
+void Environment::loadEnvironment(const Path &environmentPath,
+                                  const StorageSettings &storageSettings) {
+    const auto start = std::chrono::steady_clock::now();
+
+    EnvironmentLoader loader(environmentPath, storageSettings);
+    initialize(loader.load());
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    _loadStatistics = {.bytesRead = loader.getBytesRead(), .seconds = elapsed.count()};
+}
+
+void Environment::initialize(EnvironmentData data) {
+    _travelTimes = std::make_shared<const TravelTimes>(std::move(data.travelTimes));
+    _availableParkingSpots = std::move(data.parkingCapacities);
+    _smallestRoundTrips = _travelTimes->getSmallestRoundTrips();
+    _parkingWeights = std::move(data.parkingWeights);
+    _dropoffCoords = std::move(data.dropoffCoords);
+    _parkingCoords = std::move(data.parkingCoords);
+
+    precomputeCosts();
+    buildSpatialIndex();
+}
+
+void Environment::precomputeCosts() {
+    if (_parkingWeights.size() != getNumberOfParkings()) {
+        return;
+    }
+
+    UintVector weightedCosts(_travelTimes->getNumberOfEntries());
+    for (Uint i = 0; i < getNumberOfDropoffs(); ++i) {
+        const auto row = _travelTimes->getRow(i);
+        for (size_t k = 0; k < row.parkings.size(); ++k) {
+            const auto weight = _parkingWeights[row.parkings[k]];
+            assert(weight >= 0.0 && weight <= 2.0);
+            weightedCosts[row.offset + k] =
+                static_cast<Uint>(std::lround(row.getRoundTrip(k) * weight));
+        }
     }
 
-    const auto error = glz::read_file_json<glz::opts{.error_on_unknown_keys = false}>(
-        *this, environmentPath.string(), std::string{});
-    if (error) {
-        const auto errorStr = glz::format_error(error, std::string{});
-        throw std::runtime_error("Failed to read environment file: " + environmentPath.string() +
-                                 "\nwith error: " + errorStr);
+    _weightedCosts = std::make_shared<const UintVector>(std::move(weightedCosts));
+}
+
+void Environment::buildSpatialIndex() {
+    const auto numberOfDropoffs = getNumberOfDropoffs();
+    const auto numberOfParkings = getNumberOfParkings();
+    _parkingIndex.reset();
+    _projectedDropoffs.reset();
+    if (numberOfParkings == 0 || _dropoffCoords.size() != numberOfDropoffs ||
+        _parkingCoords.size() != numberOfParkings) {
+        return;
     }
-}
\ No newline at end of file
+
+    double latitudeSum = 0.0;
+    for (const auto &coordinate : _parkingCoords) {
+        latitudeSum += coordinate.latitude;
+    }
+    const double referenceLatitude = latitudeSum / static_cast<double>(numberOfParkings);
+
+    std::vector<Point> parkingPoints;
+    parkingPoints.reserve(numberOfParkings);
+    for (const auto &coordinate : _parkingCoords) {
+        parkingPoints.push_back(project(coordinate, referenceLatitude));
+    }
+
+    std::vector<Point> dropoffPoints;
+    dropoffPoints.reserve(numberOfDropoffs);
+    for (const auto &coordinate : _dropoffCoords) {
+        dropoffPoints.push_back(project(coordinate, referenceLatitude));
+    }
+
+    // The bound is taken over the same projected distances used for queries so pruning is exact.
+    // Pairs without stored travel times are never candidates and do not constrain it
+    double maxSpeed = 0.0;
+    for (Uint i = 0; i < numberOfDropoffs; ++i) {
+        const auto row = _travelTimes->getRow(i);
+        for (size_t k = 0; k < row.parkings.size(); ++k) {
+            const auto &parkingPoint = parkingPoints[row.parkings[k]];
+            const double distance = std::hypot(parkingPoint.x - dropoffPoints[i].x,
+                                               parkingPoint.y - dropoffPoints[i].y);
+            const auto roundTrip = row.getRoundTrip(k);
+            if (roundTrip == 0) {
+                if (distance > 0.0) {
+                    return;
+                }
+                continue;
+            }
+            maxSpeed = std::max(maxSpeed, 2.0 * distance / roundTrip);
+        }
+    }
+
+    _maxSpeed = maxSpeed;
+    _parkingIndex = std::make_shared<const SpatialIndex>(parkingPoints);
+    _projectedDropoffs = std::make_shared<const std::vector<Point>>(std::move(dropoffPoints));
+}
+
+Point Environment::project(const Coordinate &coordinate, double referenceLatitude) noexcept {
+    // Equirectangular projection is accurate enough at city scale
+    constexpr double EARTH_RADIUS = 6371000.0;
+    constexpr double TO_RADIANS = std::numbers::pi / 180.0;
+    return {.x = coordinate.longitude * TO_RADIANS * std::cos(referenceLatitude * TO_RADIANS) *
+                 EARTH_RADIUS,
+            .y = coordinate.latitude * TO_RADIANS * EARTH_RADIUS};
+}
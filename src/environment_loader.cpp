@@ -0,0 +1,379 @@
+#include "environment_loader.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+#include <stdexcept>
+
+using namespace palloc;
+
+EnvironmentLoader::EnvironmentLoader(const Path &environmentPath,
+                                     const StorageSettings &storageSettings, size_t chunkSize)
+    : _environmentPath(environmentPath),
+      _storageSettings(storageSettings),
+      _file(environmentPath, std::ios::binary),
+      _buffer(std::max<size_t>(chunkSize, 1)) {
+    if (!std::filesystem::exists(environmentPath)) {
+        throw std::runtime_error("Environment file does not exist: " + environmentPath.string());
+    }
+
+    if (!_file) {
+        throw std::runtime_error("Failed to open environment file: " + environmentPath.string());
+    }
+}
+
+EnvironmentData EnvironmentLoader::load() {
+    EnvironmentData data;
+    TravelTimesBuilder builder(_storageSettings);
+
+    skipWhitespace();
+    expect('{');
+    skipWhitespace();
+    if (peek() == '}') {
+        get();
+    } else {
+        while (true) {
+            skipWhitespace();
+            const std::string key(readString());
+            skipWhitespace();
+            expect(':');
+            skipWhitespace();
+
+            if (key == "dropoff_to_parking") {
+                readDurationMatrix(true, builder);
+            } else if (key == "parking_to_dropoff") {
+                readDurationMatrix(false, builder);
+            } else if (key == "parking_capacities") {
+                readUintArray(data.parkingCapacities);
+                checkDimension(_numberOfParkings, data.parkingCapacities.size(), key);
+            } else if (key == "smallest_round_trips") {
+                // Derived from the kept travel times instead, which a cutoff may have thinned out
+                skipValue();
+            } else if (key == "parking_weights") {
+                readDoubleArray(data.parkingWeights);
+                if (!data.parkingWeights.empty()) {
+                    checkDimension(_numberOfParkings, data.parkingWeights.size(), key);
+                }
+            } else if (key == "dropoff_coords") {
+                readCoordinates(data.dropoffCoords);
+                checkDimension(_numberOfDropoffs, data.dropoffCoords.size(), key);
+            } else if (key == "parking_coords") {
+                readCoordinates(data.parkingCoords);
+                checkDimension(_numberOfParkings, data.parkingCoords.size(), key);
+            } else {
+                skipValue();
+            }
+
+            skipWhitespace();
+            if (peek() == ',') {
+                get();
+                continue;
+            }
+
+            expect('}');
+            break;
+        }
+    }
+
+    skipWhitespace();
+    if (fillBuffer()) {
+        fail("Unexpected content after the environment object");
+    }
+
+    if (builder.getNumberOfDropoffRows() == 0 && builder.getNumberOfParkingRows() == 0) {
+        fail("Environment is missing its duration matrices");
+    }
+
+    try {
+        data.travelTimes = builder.build();
+    } catch (const std::invalid_argument &e) {
+        fail(e.what());
+    }
+
+    return data;
+}
+
+Uint64 EnvironmentLoader::getBytesRead() const noexcept { return _bytesRead; }
+
+void EnvironmentLoader::readDurationMatrix(bool isDropoffMatrix, TravelTimesBuilder &builder) {
+    const std::string_view key = isDropoffMatrix ? "dropoff_to_parking" : "parking_to_dropoff";
+    auto &rowDimension = isDropoffMatrix ? _numberOfParkings : _numberOfDropoffs;
+    auto &rowsDimension = isDropoffMatrix ? _numberOfDropoffs : _numberOfParkings;
+
+    size_t rows = 0;
+    readArray([&] {
+        readUintArray(_row);
+        checkDimension(rowDimension, _row.size(), key);
+        ++rows;
+        if (rowsDimension && rows > *rowsDimension) {
+            checkDimension(rowsDimension, rows, key);
+        }
+
+        try {
+            if (isDropoffMatrix) {
+                builder.addDropoffRow(_row);
+            } else {
+                builder.addParkingRow(_row);
+            }
+        } catch (const std::invalid_argument &e) {
+            fail(e.what());
+        }
+    });
+
+    checkDimension(rowsDimension, rows, key);
+    if (isDropoffMatrix) {
+        builder.endDropoffRows();
+    }
+}
+
+void EnvironmentLoader::readUintArray(UintVector &values) {
+    values.clear();
+    readArray([&] { values.push_back(readUint()); });
+}
+
+void EnvironmentLoader::readDoubleArray(DoubleVector &values) {
+    values.clear();
+    readArray([&] { values.push_back(readDouble()); });
+}
+
+void EnvironmentLoader::readCoordinates(Environment::Coordinates &coordinates) {
+    coordinates.clear();
+    readArray([&] { coordinates.push_back(readCoordinate()); });
+}
+
+Coordinate EnvironmentLoader::readCoordinate() {
+    Coordinate coordinate{};
+    bool hasLatitude = false;
+    bool hasLongitude = false;
+
+    expect('{');
+    skipWhitespace();
+    if (peek() != '}') {
+        while (true) {
+            skipWhitespace();
+            const auto key = readString();
+            const bool isLatitude = key == "lat";
+            const bool isLongitude = key == "lon";
+            skipWhitespace();
+            expect(':');
+            skipWhitespace();
+
+            if (isLatitude) {
+                coordinate.latitude = readDouble();
+                hasLatitude = true;
+            } else if (isLongitude) {
+                coordinate.longitude = readDouble();
+                hasLongitude = true;
+            } else {
+                skipValue();
+            }
+
+            skipWhitespace();
+            if (peek() != ',') {
+                break;
+            }
+
+            get();
+        }
+    }
+
+    expect('}');
+    if (!hasLatitude || !hasLongitude) {
+        fail("Coordinate is missing lat or lon");
+    }
+
+    return coordinate;
+}
+
+template <typename F>
+void EnvironmentLoader::readArray(F &&readElement) {
+    expect('[');
+    skipWhitespace();
+    if (peek() == ']') {
+        get();
+        return;
+    }
+
+    while (true) {
+        skipWhitespace();
+        readElement();
+        skipWhitespace();
+        if (peek() != ',') {
+            break;
+        }
+
+        get();
+    }
+
+    expect(']');
+}
+
+std::string_view EnvironmentLoader::readString() {
+    expect('"');
+    _token.clear();
+    while (true) {
+        const char c = get();
+        if (c == '"') {
+            break;
+        }
+
+        if (c == '\\') {
+            // Keys and values of interest never need unescaping, keep the escaped character as is
+            _token.push_back(get());
+            continue;
+        }
+
+        _token.push_back(c);
+    }
+
+    return _token;
+}
+
+std::string_view EnvironmentLoader::readNumber() {
+    _token.clear();
+    while (true) {
+        const char c = peek();
+        if (!std::isdigit(static_cast<unsigned char>(c)) && c != '-' && c != '+' && c != '.' &&
+            c != 'e' && c != 'E') {
+            break;
+        }
+
+        _token.push_back(get());
+    }
+
+    if (_token.empty()) {
+        fail("Expected a number");
+    }
+
+    return _token;
+}
+
+Uint EnvironmentLoader::readUint() {
+    const auto token = readNumber();
+    Uint value{};
+    const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (error != std::errc{} || end != token.data() + token.size()) {
+        fail("Expected a non-negative integer but got " + std::string(token));
+    }
+
+    return value;
+}
+
+double EnvironmentLoader::readDouble() {
+    const auto token = readNumber();
+    double value{};
+    const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (error != std::errc{} || end != token.data() + token.size()) {
+        fail("Expected a number but got " + std::string(token));
+    }
+
+    return value;
+}
+
+void EnvironmentLoader::skipValue() {
+    const char c = peek();
+    if (c == '{') {
+        get();
+        skipWhitespace();
+        if (peek() == '}') {
+            get();
+            return;
+        }
+
+        while (true) {
+            skipWhitespace();
+            readString();
+            skipWhitespace();
+            expect(':');
+            skipWhitespace();
+            skipValue();
+            skipWhitespace();
+            if (peek() != ',') {
+                break;
+            }
+
+            get();
+        }
+
+        expect('}');
+    } else if (c == '[') {
+        readArray([this] { skipValue(); });
+    } else if (c == '"') {
+        readString();
+    } else if (c == 't' || c == 'f' || c == 'n') {
+        while (std::isalpha(static_cast<unsigned char>(peek()))) {
+            get();
+        }
+    } else {
+        readNumber();
+    }
+}
+
+bool EnvironmentLoader::fillBuffer() {
+    if (_position < _size) {
+        return true;
+    }
+
+    _file.read(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+    _size = static_cast<size_t>(_file.gcount());
+    _position = 0;
+    _bytesRead += _size;
+    return _size > 0;
+}
+
+char EnvironmentLoader::peek() {
+    if (!fillBuffer()) {
+        // Not a valid JSON character, so every expectation fails at the end of the file
+        return '\0';
+    }
+
+    return _buffer[_position];
+}
+
+char EnvironmentLoader::get() {
+    if (!fillBuffer()) {
+        fail("Unexpected end of file");
+    }
+
+    return _buffer[_position++];
+}
+
+void EnvironmentLoader::skipWhitespace() {
+    while (std::isspace(static_cast<unsigned char>(peek()))) {
+        ++_position;
+    }
+}
+
+void EnvironmentLoader::expect(char expected) {
+    const char c = peek();
+    if (c != expected) {
+        if (_position >= _size) {
+            fail("Unexpected end of file");
+        }
+
+        fail(std::string("Expected '") + expected + "' but got '" + c + "'");
+    }
+
+    ++_position;
+}
+
+void EnvironmentLoader::checkDimension(std::optional<size_t> &dimension, size_t actual,
+                                       std::string_view key) {
+    if (!dimension) {
+        dimension = actual;
+        return;
+    }
+
+    if (*dimension != actual) {
+        fail("Dimension of " + std::string(key) + " is " + std::to_string(actual) +
+             " but other arrays imply " + std::to_string(*dimension));
+    }
+}
+
+void EnvironmentLoader::fail(std::string_view message) const {
+    const auto offset = _bytesRead - (_size - _position);
+    throw std::runtime_error("Failed to read environment file: " + _environmentPath.string() +
+                             "\nwith error: " + std::string(message) + " at byte " +
+                             std::to_string(offset));
+}
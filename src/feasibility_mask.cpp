@@ -0,0 +1,131 @@
+#include "feasibility_mask.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PALLOC_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace palloc;
+
+using Duration = TravelTimes::Duration;
+
+/**
+ * Set the bits of the entries in [begin, end) which fit in the budget, the words must be cleared
+ */
+using MaskKernel = void (*)(const Duration *toParking, const Duration *toDropoff, size_t begin,
+                            size_t end, Uint budget, Uint64 *words);
+
+static void computeWordsScalar(const Duration *toParking, const Duration *toDropoff,
+                               size_t begin, size_t end, Uint budget, Uint64 *words) {
+    for (size_t k = begin; k < end; ++k) {
+        const Uint roundTrip = static_cast<Uint>(toParking[k]) + toDropoff[k];
+        words[k / 64] |= static_cast<Uint64>(roundTrip <= budget) << (k % 64);
+    }
+}
+
+#ifdef PALLOC_X86_KERNELS
+// Lanes are widened to 32 bits since a round trip of two 16 bit legs can overflow 16 bits. Blocks
+// never straddle a word as their size divides 64.
+
+__attribute__((target("avx2"))) static void computeWordsAvx2(const Duration *toParking,
+                                                             const Duration *toDropoff,
+                                                             size_t begin, size_t end, Uint budget,
+                                                             Uint64 *words) {
+    constexpr size_t LANES = 8;
+    assert(begin % LANES == 0);
+
+    // Round trips are below 2^17, so clamping the budget keeps the signed comparison exact
+    constexpr Uint MAX_ROUND_TRIP = 2 * static_cast<Uint>(std::numeric_limits<Duration>::max());
+    const auto limit = _mm256_set1_epi32(static_cast<int>(std::min(budget, MAX_ROUND_TRIP)));
+
+    size_t k = begin;
+    for (; k + LANES <= end; k += LANES) {
+        const auto toParkingLanes = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(toParking + k)));
+        const auto toDropoffLanes = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(toDropoff + k)));
+        const auto tooLong =
+            _mm256_cmpgt_epi32(_mm256_add_epi32(toParkingLanes, toDropoffLanes), limit);
+        const auto fits = ~static_cast<Uint>(_mm256_movemask_ps(_mm256_castsi256_ps(tooLong)));
+        words[k / 64] |= static_cast<Uint64>(fits & 0xFFU) << (k % 64);
+    }
+
+    computeWordsScalar(toParking, toDropoff, k, end, budget, words);
+}
+
+__attribute__((target("avx512f"))) static void computeWordsAvx512(const Duration *toParking,
+                                                                  const Duration *toDropoff,
+                                                                  size_t begin, size_t end,
+                                                                  Uint budget, Uint64 *words) {
+    constexpr size_t LANES = 16;
+    assert(begin % LANES == 0);
+
+    const auto limit = _mm512_set1_epi32(static_cast<int>(budget));
+
+    size_t k = begin;
+    for (; k + LANES <= end; k += LANES) {
+        const auto toParkingLanes = _mm512_cvtepu16_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(toParking + k)));
+        const auto toDropoffLanes = _mm512_cvtepu16_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(toDropoff + k)));
+        const __mmask16 fits =
+            _mm512_cmple_epu32_mask(_mm512_add_epi32(toParkingLanes, toDropoffLanes), limit);
+        words[k / 64] |= static_cast<Uint64>(fits) << (k % 64);
+    }
+
+    computeWordsScalar(toParking, toDropoff, k, end, budget, words);
+}
+#endif
+
+struct SelectedKernel {
+    MaskKernel kernel;
+    std::string_view instructionSet;
+};
+
+static SelectedKernel selectKernel() {
+#ifdef PALLOC_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return {.kernel = computeWordsAvx512, .instructionSet = "avx512"};
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        return {.kernel = computeWordsAvx2, .instructionSet = "avx2"};
+    }
+#endif
+
+    return {.kernel = computeWordsScalar, .instructionSet = "scalar"};
+}
+
+static const SelectedKernel &getSelectedKernel() {
+    static const SelectedKernel selected = selectKernel();
+    return selected;
+}
+
+static void computeWith(MaskKernel kernel, FeasibilityMask::Durations toParking,
+                        FeasibilityMask::Durations toDropoff, Uint budget,
+                        FeasibilityMask::Words &mask) {
+    assert(toParking.size() == toDropoff.size());
+
+    const size_t count = toParking.size();
+    mask.assign((count + 63) / 64, 0);
+    kernel(toParking.data(), toDropoff.data(), 0, count, budget, mask.data());
+}
+
+void FeasibilityMask::compute(Durations toParking, Durations toDropoff, Uint budget,
+                              Words &mask) {
+    computeWith(getSelectedKernel().kernel, toParking, toDropoff, budget, mask);
+}
+
+void FeasibilityMask::computeScalar(Durations toParking, Durations toDropoff, Uint budget,
+                                    Words &mask) {
+    computeWith(computeWordsScalar, toParking, toDropoff, budget, mask);
+}
+
+std::string_view FeasibilityMask::getInstructionSet() noexcept {
+    return getSelectedKernel().instructionSet;
+}
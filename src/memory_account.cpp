@@ -0,0 +1,93 @@
+#include "memory_account.hpp"
+
+#include <fstream>
+#include <string_view>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+using namespace palloc;
+
+static thread_local MemoryAccount *currentAccount = nullptr;
+
+void MemoryAccount::Counters::add(Int64 bytes) noexcept {
+    const Int64 newLiveBytes = liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (bytes <= 0) {
+        return;
+    }
+
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    Int64 peak = peakBytes.load(std::memory_order_relaxed);
+    while (newLiveBytes > peak &&
+           !peakBytes.compare_exchange_weak(peak, newLiveBytes, std::memory_order_relaxed)) {
+    }
+}
+
+void MemoryAccount::allocate(MemoryCategory category, size_t bytes) noexcept {
+    _categories[static_cast<size_t>(category)].add(static_cast<Int64>(bytes));
+    _total.add(static_cast<Int64>(bytes));
+}
+
+void MemoryAccount::deallocate(MemoryCategory category, size_t bytes) noexcept {
+    _categories[static_cast<size_t>(category)].add(-static_cast<Int64>(bytes));
+    _total.add(-static_cast<Int64>(bytes));
+}
+
+CategoryMemory MemoryAccount::getCategoryMemory(MemoryCategory category) const noexcept {
+    const auto &counters = _categories[static_cast<size_t>(category)];
+    return {.peakBytes = static_cast<Uint64>(counters.peakBytes.load()),
+            .allocations = counters.allocations.load()};
+}
+
+RunMemory MemoryAccount::getRunMemory() const noexcept {
+    return {.traces = getCategoryMemory(MemoryCategory::TRACES),
+            .assignments = getCategoryMemory(MemoryCategory::ASSIGNMENTS),
+            .simulations = getCategoryMemory(MemoryCategory::SIMULATIONS),
+            .requests = getCategoryMemory(MemoryCategory::REQUESTS),
+            .environment = getCategoryMemory(MemoryCategory::ENVIRONMENT),
+            .peakBytes = static_cast<Uint64>(_total.peakBytes.load())};
+}
+
+MemoryAccount *MemoryAccount::getCurrent() noexcept { return currentAccount; }
+
+Uint64 MemoryAccount::getResidentBytes() {
+#if defined(__linux__)
+    // Second field of statm is the resident set in pages
+    std::ifstream statm("/proc/self/statm");
+    Uint64 size = 0;
+    Uint64 resident = 0;
+    if (statm >> size >> resident) {
+        return resident * static_cast<Uint64>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+
+    return 0;
+}
+
+Uint64 MemoryAccount::getPeakResidentBytes() {
+#if defined(__linux__)
+    constexpr std::string_view field = "VmHWM:";
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.starts_with(field)) {
+            return std::stoull(line.substr(field.size())) * 1024;
+        }
+    }
+#endif
+
+    return 0;
+}
+
+PhaseMemory MemoryAccount::samplePhase(std::string phase) {
+    return {.phase = std::move(phase),
+            .residentBytes = getResidentBytes(),
+            .peakResidentBytes = getPeakResidentBytes()};
+}
+
+MemoryScope::MemoryScope(MemoryAccount *account) noexcept : _previous(currentAccount) {
+    currentAccount = account;
+}
+
+MemoryScope::~MemoryScope() { currentAccount = _previous; }
@@ -0,0 +1,86 @@
+#include "occupancy_timeline.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace palloc;
+
+void OccupancyTimeline::advance(Uint timestep) {
+    assert(timestep >= _timestep);
+    _timestep = timestep;
+    for (auto &events : _events) {
+        events.erase(events.begin(), events.upper_bound(timestep));
+    }
+}
+
+void OccupancyTimeline::addClaim(size_t parkingNode, Uint timestep) {
+    assert(timestep > _timestep);
+    --_events[parkingNode][timestep];
+}
+
+void OccupancyTimeline::addRelease(size_t parkingNode, Uint timestep) {
+    assert(timestep > _timestep);
+    ++_events[parkingNode][timestep];
+}
+
+std::vector<CapacityWindow> OccupancyTimeline::getCapacityWindows(
+    size_t parkingNode, Uint freeNow, std::span<const OccupancyInterval> intervals) const {
+    if (intervals.empty()) {
+        return {};
+    }
+
+    const auto &events = _events[parkingNode];
+
+    Uint first = intervals.front().start;
+    Uint last = intervals.front().end;
+    UintVector checkpoints;
+    checkpoints.reserve(intervals.size());
+    for (const auto &interval : intervals) {
+        first = std::min(first, interval.start);
+        last = std::max(last, interval.end);
+        checkpoints.push_back(interval.start);
+    }
+
+    for (auto iter = events.lower_bound(first); iter != events.end() && iter->first < last;
+         ++iter) {
+        checkpoints.push_back(iter->first);
+    }
+
+    std::ranges::sort(checkpoints);
+    const auto [uniqueBegin, uniqueEnd] = std::ranges::unique(checkpoints);
+    checkpoints.erase(uniqueBegin, uniqueEnd);
+
+    std::vector<CapacityWindow> windows;
+    Int64 freeSpots = freeNow;
+    auto event = events.begin();
+    for (const auto checkpoint : checkpoints) {
+        for (; event != events.end() && event->first <= checkpoint; ++event) {
+            freeSpots += event->second;
+        }
+
+        CapacityWindow window{.freeSpots = static_cast<Uint>(std::max<Int64>(freeSpots, 0)),
+                              .requests = {}};
+        for (const auto &interval : intervals) {
+            if (interval.start <= checkpoint && checkpoint < interval.end) {
+                window.requests.push_back(interval.request);
+            }
+        }
+
+        if (window.requests.size() > window.freeSpots) {
+            windows.push_back(std::move(window));
+        }
+    }
+
+    return windows;
+}
+
+Uint OccupancyTimeline::getTimestep() const noexcept { return _timestep; }
+
+Uint OccupancyTimeline::getReleaseTimestep(Uint timestep, Uint tillArrival, Uint requestDuration,
+                                           Uint timeToDrive) noexcept {
+    assert(requestDuration >= timeToDrive);
+
+    // The spot is freed the timestep after the vehicle has timeToDrive left, or when it is done
+    const Uint release = timestep + tillArrival + requestDuration - timeToDrive;
+    return timeToDrive > 0 ? release + 1 : release;
+}
@@ -2,12 +2,58 @@
 
 using namespace palloc;
 
+/**
+ * palloc merge -o <output> <shard files...>
+ */
+static int mergeShards(int argc, char **argv) {
+    Path outputPath;
+    std::vector<Path> shardPaths;
+    for (int i = 0; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            std::println("Usage: palloc merge -o <output> <shard files...>");
+            return EXIT_SUCCESS;
+        }
+
+        if (arg == "-o" || arg == "--output") {
+            if (i + 1 == argc) {
+                std::println(stderr, "Error: Expected output file after {}", arg);
+                return EXIT_FAILURE;
+            }
+
+            outputPath = argv[++i];
+        } else {
+            shardPaths.emplace_back(arg);
+        }
+    }
+
+    if (outputPath.empty()) {
+        std::println(stderr, "Error: Expected output file");
+        return EXIT_FAILURE;
+    }
+
+    if (shardPaths.empty()) {
+        std::println(stderr, "Error: Expected shard files to merge");
+        return EXIT_FAILURE;
+    }
+
+    Shard::merge(shardPaths, outputPath);
+    std::println("Merged {} shards into {}", shardPaths.size(), outputPath.string());
+    return EXIT_SUCCESS;
+}
+
 int main(int argc, char **argv) {
     try {
+        if (argc > 1 && std::string_view(argv[1]) == "merge") {
+            return mergeShards(argc - 2, argv + 2);
+        }
+
         argz::about about{"Palloc", "0.0.1"};
 
         std::string environmentPathStr;
         std::string outputPathStr;
+        std::string recordPathStr;
+        std::string checkpointPathStr;
         SimulatorSettings simSettings{.timesteps = 1440,
                                       .maxRequestDuration = 2880,
                                       .requestRate = 4.0,
@@ -16,18 +62,50 @@ int main(int argc, char **argv) {
                                       .batchInterval = 2,
                                       .commitInterval = 0,
                                       .useWeightedParking = false,
-                                      .randomGenerator = "pcg"};
+                                      .randomGenerator = "pcg",
+                                      .replaySpeed = 1,
+                                      .warmupTimesteps = 0,
+                                      .horizon = 0,
+                                      .useTimeExpanded = false,
+                                      .batchSize = 0,
+                                      .schedulerBackend = "auto",
+                                      .commonRandomNumbers = false,
+                                      .antithetic = false};
+
+        OutputSettings outputSettings{.numberOfRunsToAggregate = 3,
+                                      .prettify = false,
+                                      .outputTrace = false,
+                                      .outputReport = false,
+                                      .accountMemory = false,
+                                      .checkpointInterval = 60,
+                                      .resume = false,
+                                      .shardIndex = 0,
+                                      .shardCount = 1};
 
-        OutputSettings outputSettings{
-            .numberOfRunsToAggregate = 3, .prettify = false, .outputTrace = false};
+        StorageSettings storageSettings{.travelTimeCutoff = 0, .nearestParkings = 0};
 
         std::optional<Uint> seedOpt;
         std::string startTimeStr = "08:00";
 
         std::optional<Uint> numberOfThreadsOpt;
+        bool verbose = false;
+
+        std::string branchesStr;
+        std::string shardStr;
+
+        ServiceSettings serviceSettings{.batchWindow = 100, .maxBatchSize = 256};
+        bool serve = false;
+        bool serviceBenchmark = false;
 
         argz::options opts{
             {{"environment", 'e'}, environmentPathStr, "the environment file to simulate"},
+            {{"travel-time-cutoff", 'C'},
+             storageSettings.travelTimeCutoff,
+             "only keep dropoff to parking pairs with round trips up to this many minutes, 0 to "
+             "keep all"},
+            {{"nearest-parkings", 'N'},
+             storageSettings.nearestParkings,
+             "only keep this many parkings nearest to each dropoff, 0 to keep all"},
             {{"timesteps", 't'}, simSettings.timesteps, "timesteps in minutes to run simulation"},
             {{"start-time", 'S'}, startTimeStr, "time to start simulation"},
             {{"duration", 'd'},
@@ -45,28 +123,97 @@ int main(int argc, char **argv) {
             {{"batch-interval", 'b'},
              simSettings.batchInterval,
              "interval in minutes before processing requests"},
+            {{"batch-size", 'Z'},
+             simSettings.batchSize,
+             "solve as soon as this many new requests are pending, treating the batch interval as "
+             "the longest a request may wait, 0 to solve every batch interval"},
             {{"commit-interval", 'c'},
              simSettings.commitInterval,
              "interval before arriving a request can be committed to a parking spot"},
             {{"weighted-parking", 'w'},
              simSettings.useWeightedParking,
              "use weighted parking cost depending on dropoff node density"},
+            {{"horizon", 'H'},
+             simSettings.horizon,
+             "minutes of forecast demand to keep parking spots free for, 0 to disable"},
+            {{"time-expanded", 'E'},
+             simSettings.useTimeExpanded,
+             "commit early requests against the capacity at their arrival instead of deferring "
+             "them"},
+            {{"scheduler", 'Y'},
+             simSettings.schedulerBackend,
+             "scheduler backend to use (options: auto, cp-sat, aggregated)"},
             {{"random-generator", 'g'},
              simSettings.randomGenerator,
              "random generator to use (options: pcg, pcg-fast)"},
             {{"seed", 's'}, seedOpt, "seed for randomization, default: unix timestamp"},
+            {{"common-random-numbers", 'q'},
+             simSettings.commonRandomNumbers,
+             "generate the requests of every timestep from a substream keyed by seed, run and "
+             "timestep, so configurations compared with the same seed see identical demand"},
+            {{"antithetic", 'x'},
+             simSettings.antithetic,
+             "pair every odd run with the complementary random draws of the preceding run, "
+             "requires common random numbers"},
+            {{"replay", 'P'},
+             simSettings.replayFile,
+             "request recording to replay instead of generating requests"},
+            {{"replay-speed", 'X'},
+             simSettings.replaySpeed,
+             "recorded timesteps to replay per simulated timestep"},
+            {{"record", 'R'},
+             recordPathStr,
+             "file to record requests to, one file per run when aggregating"},
             {{"output", 'o'},
              outputPathStr,
              "the output file to store results in, default: no output"},
             {{"trace", 'T'}, outputSettings.outputTrace, "whether to output trace or not"},
+            {{"report", 'G'},
+             outputSettings.outputReport,
+             "whether to output per timestep report aggregates across runs or not"},
+            {{"memory", 'L'},
+             outputSettings.accountMemory,
+             "whether to account peak memory per run and phase or not"},
             {{"prettify", 'p'}, outputSettings.prettify, "whether to prettify output or not"},
             {{"aggregate", 'a'},
              outputSettings.numberOfRunsToAggregate,
              "number of runs to aggregate together"},
+            {{"checkpoint", 'k'},
+             checkpointPathStr,
+             "file to periodically checkpoint runs to, one file per run when aggregating"},
+            {{"checkpoint-interval", 'K'},
+             outputSettings.checkpointInterval,
+             "timesteps between checkpoints"},
+            {{"resume", 'u'},
+             outputSettings.resume,
+             "resume runs from their checkpoints, requires the seed of the original runs"},
+            {{"warmup", 'U'},
+             simSettings.warmupTimesteps,
+             "timesteps simulated once and shared by all branches"},
+            {{"branches", 'F'},
+             branchesStr,
+             "branches to fork after the warm-up separated by ';', each a ',' separated list of "
+             "overrides, e.g. \"batch-interval=5;commit-interval=10,weighted-parking=true\""},
+            {{"shard", 'n'},
+             shardStr,
+             "only simulate shard i/N of the runs and branches, merged with palloc merge"},
             {{"jobs", 'j'},
              numberOfThreadsOpt,
              "number of threads to use for aggregation, default: min(number of hardware threads, "
-             "number of aggregates)"}};
+             "number of aggregates)"},
+            {{"verbose", 'V'}, verbose, "print loading statistics"},
+            {{"serve", 'D'},
+             serve,
+             "run as a service reading requests from stdin and writing assignments to stdout"},
+            {{"serve-bench", 'B'},
+             serviceBenchmark,
+             "replay generated requests through the service and report throughput and latency"},
+            {{"batch-window", 'W'},
+             serviceSettings.batchWindow,
+             "service batching window in milliseconds before pending requests are solved"},
+            {{"max-batch-size", 'M'},
+             serviceSettings.maxBatchSize,
+             "service batch size which triggers an early solve, 0 for no limit"}};
 
         argz::parse(about, opts, argc, argv);
         if (about.printed_help || about.printed_version) {
@@ -105,22 +252,118 @@ int main(int argc, char **argv) {
             return EXIT_FAILURE;
         }
 
+        if (!Scheduler::availableBackends.contains(simSettings.schedulerBackend)) {
+            std::println(stderr,
+                         "Error: Scheduler backend must be one of auto, cp-sat or aggregated");
+            return EXIT_FAILURE;
+        }
+
+        if (simSettings.replaySpeed < 1) {
+            std::println(stderr, "Error: Replay speed must be a natural number");
+            return EXIT_FAILURE;
+        }
+
         if (outputSettings.numberOfRunsToAggregate < 1) {
             std::println(stderr, "Error: Number of aggregates must be a natural number");
             return EXIT_FAILURE;
         }
 
-        Environment env(environmentPathStr);
+        if (!checkpointPathStr.empty() && outputSettings.checkpointInterval < 1) {
+            std::println(stderr, "Error: Checkpoint interval must be a natural number");
+            return EXIT_FAILURE;
+        }
+
+        if (outputSettings.resume && (checkpointPathStr.empty() || !seedOpt)) {
+            std::println(stderr, "Error: Resume requires a checkpoint file and a seed");
+            return EXIT_FAILURE;
+        }
+
+        if (simSettings.commonRandomNumbers && !seedOpt) {
+            std::println(stderr, "Error: Common random numbers require a seed to share");
+            return EXIT_FAILURE;
+        }
+
+        if (simSettings.antithetic && !simSettings.commonRandomNumbers) {
+            std::println(stderr, "Error: Antithetic runs require common random numbers (-q)");
+            return EXIT_FAILURE;
+        }
+
+        const bool branching = !branchesStr.empty();
+        if (branching && simSettings.warmupTimesteps >= simSettings.timesteps) {
+            std::println(stderr, "Error: Warm-up must be shorter than the number of timesteps");
+            return EXIT_FAILURE;
+        }
+
+        if (!branching && simSettings.warmupTimesteps > 0) {
+            std::println(stderr, "Error: Warm-up requires branches to fork into");
+            return EXIT_FAILURE;
+        }
+
+        if (branching && (!checkpointPathStr.empty() || !recordPathStr.empty())) {
+            std::println(stderr,
+                         "Error: Branches cannot be combined with checkpoints or recording");
+            return EXIT_FAILURE;
+        }
+
+        if (!shardStr.empty()) {
+            std::tie(outputSettings.shardIndex, outputSettings.shardCount) =
+                Shard::parse(shardStr);
+            if (outputPathStr.empty()) {
+                std::println(stderr, "Error: Sharding requires an output file");
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (serve && serviceBenchmark) {
+            std::println(stderr, "Error: Serve and serve-bench cannot be combined");
+            return EXIT_FAILURE;
+        }
+
+        Environment env(environmentPathStr, storageSettings);
+        if (verbose) {
+            const auto &loadStatistics = env.getLoadStatistics();
+            const double megabytes = static_cast<double>(loadStatistics.bytesRead) / 1e6;
+            const double throughput =
+                loadStatistics.seconds > 0.0 ? megabytes / loadStatistics.seconds : 0.0;
+            std::println("Loaded environment: {:.1f} MB in {:.3f} s ({:.1f} MB/s)", megabytes,
+                         loadStatistics.seconds, throughput);
+            std::println("Feasibility kernel: {}", FeasibilityMask::getInstructionSet());
+        }
 
         simSettings.seed =
             seedOpt.value_or(std::chrono::system_clock::now().time_since_epoch().count());
         outputSettings.outputPath = outputPathStr;
+        outputSettings.recordPath = recordPathStr;
+        outputSettings.checkpointPath = checkpointPathStr;
+
+        if (serve) {
+            Service::serve(env, simSettings, serviceSettings);
+            return EXIT_SUCCESS;
+        }
+
+        if (serviceBenchmark) {
+            Service::benchmark(env, simSettings, serviceSettings);
+            return EXIT_SUCCESS;
+        }
+
+        std::vector<SimulatorSettings> branchSettings;
+        if (branching) {
+            branchSettings = BranchParser::parse(branchesStr, simSettings);
+        }
 
+        const auto jobs = static_cast<Uint>(outputSettings.numberOfRunsToAggregate *
+                                            std::max<size_t>(branchSettings.size(), 1));
         GeneralSettings generalSettings{
-            .numberOfThreads = numberOfThreadsOpt.value_or(std::min(
-                std::thread::hardware_concurrency(), outputSettings.numberOfRunsToAggregate))};
+            .numberOfThreads =
+                numberOfThreadsOpt.value_or(std::min(std::thread::hardware_concurrency(), jobs)),
+            .pipelined = outputSettings.numberOfRunsToAggregate == 1};
 
-        Simulator::simulate(env, simSettings, outputSettings, generalSettings);
+        if (branching) {
+            Simulator::simulateBranches(env, simSettings, branchSettings, outputSettings,
+                                        generalSettings);
+        } else {
+            Simulator::simulate(env, simSettings, outputSettings, generalSettings);
+        }
     } catch (std::exception &e) {
         std::println(stderr, "Error: {}", e.what());
         return EXIT_FAILURE;
@@ -16,11 +16,26 @@ std::unique_ptr<RandomEngine> RandomEngineFactory::create(std::string_view gener
     throw std::invalid_argument("Unknown random generator: " + std::string(generatorName));
 }
 
-PcgEngine::PcgEngine(Uint seed) {
-    _state = seed + _increment;
-    operator()();
+Uint64 random::mixSeed(Uint64 seed, Uint64 key) noexcept {
+    Uint64 z = seed + (key + 1) * 0x9e3779b97f4a7c15U;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9U;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebU;
+    return z ^ (z >> 31);
 }
 
+AntitheticEngine::AntitheticEngine(std::unique_ptr<RandomEngine> engine)
+    : _engine(std::move(engine)) {}
+
+Uint AntitheticEngine::operator()() { return max() - (*_engine)(); }
+
+Uint64 AntitheticEngine::getState() const noexcept { return _engine->getState(); }
+
+void AntitheticEngine::setState(Uint64 state) noexcept { _engine->setState(state); }
+
+void AntitheticEngine::reseed(Uint64 seed) noexcept { _engine->reseed(seed); }
+
+PcgEngine::PcgEngine(Uint seed) { PcgEngine::reseed(seed); }
+
 Uint PcgEngine::operator()() {
     Uint64 x = _state;
     Uint count = static_cast<Uint>((x >> 59)) + 1;
@@ -29,17 +44,32 @@ Uint PcgEngine::operator()() {
     return rotr32(static_cast<Uint>(x >> 27), count);
 }
 
-Uint PcgEngine::rotr32(Uint x, Uint r) noexcept { return x >> r | x << (-r & 31); }
+Uint64 PcgEngine::getState() const noexcept { return _state; }
 
-PcgEngineFast::PcgEngineFast(Uint seed) {
-    _state = 2 * seed + 1;
+void PcgEngine::setState(Uint64 state) noexcept { _state = state; }
+
+void PcgEngine::reseed(Uint64 seed) noexcept {
+    _state = seed + _increment;
     operator()();
 }
 
+Uint PcgEngine::rotr32(Uint x, Uint r) noexcept { return x >> r | x << (-r & 31); }
+
+PcgEngineFast::PcgEngineFast(Uint seed) { PcgEngineFast::reseed(seed); }
+
 Uint PcgEngineFast::operator()() {
     Uint64 x = _state;
     Uint count = static_cast<Uint>(x >> 61);
     _state = x * _multiplier;
     x ^= x >> 22;
     return static_cast<Uint>(x >> (22 + count));
-}
\ No newline at end of file
+}
+
+Uint64 PcgEngineFast::getState() const noexcept { return _state; }
+
+void PcgEngineFast::setState(Uint64 state) noexcept { _state = state; }
+
+void PcgEngineFast::reseed(Uint64 seed) noexcept {
+    _state = 2 * seed + 1;
+    operator()();
+}
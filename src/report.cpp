@@ -0,0 +1,126 @@
+#include "report.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace palloc;
+
+RunReport::RunReport(const UintVector &parkingCapacities)
+    : _parkingCapacities(parkingCapacities), _occupiedSpotMinutes(parkingCapacities.size(), 0) {}
+
+void RunReport::addTimestep(const UintVector &availableParkingSpots, size_t droppedRequests,
+                            double cost, double duration) {
+    assert(availableParkingSpots.size() == _parkingCapacities.size());
+
+    Uint availableSpots = 0;
+    for (size_t j = 0; j < availableParkingSpots.size(); ++j) {
+        availableSpots += availableParkingSpots[j];
+        _occupiedSpotMinutes[j] += _parkingCapacities[j] - availableParkingSpots[j];
+    }
+
+    _availableSpots.push_back(availableSpots);
+    _droppedRequests.push_back(droppedRequests);
+    _costs.push_back(cost);
+    _durations.push_back(duration);
+}
+
+void RunReport::addRouteDuration(Uint routeDuration) {
+    if (routeDuration >= _routeDurationCounts.size()) {
+        _routeDurationCounts.resize(routeDuration + 1, 0);
+    }
+
+    ++_routeDurationCounts[routeDuration];
+}
+
+const UintVector &RunReport::getParkingCapacities() const noexcept { return _parkingCapacities; }
+
+const std::vector<Uint64> &RunReport::getOccupiedSpotMinutes() const noexcept {
+    return _occupiedSpotMinutes;
+}
+
+const UintVector &RunReport::getAvailableSpots() const noexcept { return _availableSpots; }
+
+const std::vector<Uint64> &RunReport::getDroppedRequests() const noexcept {
+    return _droppedRequests;
+}
+
+const DoubleVector &RunReport::getCosts() const noexcept { return _costs; }
+
+const DoubleVector &RunReport::getDurations() const noexcept { return _durations; }
+
+const std::vector<Uint64> &RunReport::getRouteDurationCounts() const noexcept {
+    return _routeDurationCounts;
+}
+
+void ReportBuilder::SeriesTotals::add(size_t timestep, double value) {
+    if (timestep == sum.size()) {
+        sum.push_back(value);
+        min.push_back(value);
+        max.push_back(value);
+        runs.push_back(1);
+        return;
+    }
+
+    sum[timestep] += value;
+    min[timestep] = std::min(min[timestep], value);
+    max[timestep] = std::max(max[timestep], value);
+    ++runs[timestep];
+}
+
+SeriesAggregate ReportBuilder::SeriesTotals::build() const {
+    SeriesAggregate series{.mean = DoubleVector(sum.size()), .min = min, .max = max};
+    for (size_t t = 0; t < sum.size(); ++t) {
+        series.mean[t] = sum[t] / static_cast<double>(runs[t]);
+    }
+
+    return series;
+}
+
+static void addCounts(const std::vector<Uint64> &counts, std::vector<Uint64> &totals) {
+    if (counts.size() > totals.size()) {
+        totals.resize(counts.size(), 0);
+    }
+
+    for (size_t i = 0; i < counts.size(); ++i) {
+        totals[i] += counts[i];
+    }
+}
+
+void ReportBuilder::add(const RunReport &report) {
+    for (size_t t = 0; t < report.getAvailableSpots().size(); ++t) {
+        _availableSpots.add(t, report.getAvailableSpots()[t]);
+        _droppedRequests.add(t, static_cast<double>(report.getDroppedRequests()[t]));
+        _cost.add(t, report.getCosts()[t]);
+        _duration.add(t, report.getDurations()[t]);
+    }
+
+    addCounts(report.getRouteDurationCounts(), _routeDurationHistogram);
+    addCounts(report.getOccupiedSpotMinutes(), _occupiedSpotMinutes);
+
+    const Uint64 timesteps = report.getAvailableSpots().size();
+    std::vector<Uint64> spotMinutes;
+    spotMinutes.reserve(report.getParkingCapacities().size());
+    for (const auto capacity : report.getParkingCapacities()) {
+        spotMinutes.push_back(capacity * timesteps);
+    }
+
+    addCounts(spotMinutes, _spotMinutes);
+}
+
+ReportAggregates ReportBuilder::build() const {
+    ReportAggregates aggregates{.availableSpots = _availableSpots.build(),
+                                .droppedRequests = _droppedRequests.build(),
+                                .cost = _cost.build(),
+                                .duration = _duration.build(),
+                                .routeDurationHistogram = _routeDurationHistogram,
+                                .parkingUtilization = DoubleVector(_spotMinutes.size(), 0.0)};
+
+    for (size_t j = 0; j < _spotMinutes.size(); ++j) {
+        if (_spotMinutes[j] > 0) {
+            aggregates.parkingUtilization[j] = static_cast<double>(_occupiedSpotMinutes[j]) /
+                                               static_cast<double>(_spotMinutes[j]);
+        }
+    }
+
+    return aggregates;
+}
@@ -10,6 +10,10 @@ Uint Request::getArrival() const noexcept { return _tillArrival; }
 
 Uint Request::getTimesDropped() const noexcept { return _timesDropped; }
 
+Uint Request::getId() const noexcept { return _id; }
+
+void Request::setId(Uint id) noexcept { _id = id; }
+
 void Request::decrementDuration() noexcept { --_requestDuration; }
 
 void Request::decrementTillArrival() noexcept { --_tillArrival; }
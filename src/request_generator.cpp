@@ -4,19 +4,37 @@
 
 using namespace palloc;
 
+// The count and the requests draw from separate substreams, since the number of draws a poisson
+// sample takes depends on the rate. Configurations with different rates then still share the
+// first requests of every timestep.
+static constexpr Uint64 COUNT_SUBSTREAM = 0;
+static constexpr Uint64 REQUEST_SUBSTREAM = 1;
+
 Requests RequestGenerator::generate(Uint currentTimeOfDay) {
+    enterSubstream(COUNT_SUBSTREAM);
     const auto count = getCount(currentTimeOfDay);
-    _requestsGenerated += count;
+
+    enterSubstream(REQUEST_SUBSTREAM);
 
     Requests requests;
     requests.reserve(count);
     for (Uint i = 0; i < count; ++i) {
-        requests.emplace_back(getDropoff(), getDuration(), getArrival());
+        auto &request = requests.emplace_back(getDropoff(), getDuration(), getArrival());
+        request.setId(_requestsGenerated + i);
     }
 
+    _requestsGenerated += count;
+    ++_timestep;
+
     return requests;
 }
 
+void RequestGenerator::enterSubstream(Uint64 substream) {
+    if (_commonRandomNumbers) {
+        _rng->reseed(random::mixSeed(random::mixSeed(_streamSeed, _timestep), substream));
+    }
+}
+
 Uint RequestGenerator::getCount(Uint currentTimeOfDay) {
     const auto multiplier = getTimeMultiplier(currentTimeOfDay);
     const double adjustedRate = _requestRate * multiplier;
@@ -40,6 +58,19 @@ Uint RequestGenerator::getDuration() {
 
 Uint RequestGenerator::getRequestsGenerated() const noexcept { return _requestsGenerated; }
 
+RequestSourceState RequestGenerator::getState() const {
+    return {.rngState = _rng->getState(),
+            .offset = 0,
+            .timestep = _timestep,
+            .requestsGenerated = _requestsGenerated};
+}
+
+void RequestGenerator::setState(const RequestSourceState &state) {
+    _rng->setState(state.rngState);
+    _requestsGenerated = state.requestsGenerated;
+    _timestep = state.timestep;
+}
+
 double RequestGenerator::getTimeMultiplier(Uint currentTimeOfDay) {
     const Uint hour = currentTimeOfDay / 60;
     assert(hour < 24);
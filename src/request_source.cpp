@@ -0,0 +1,216 @@
+#include "request_source.hpp"
+
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+#include "request_generator.hpp"
+#include "settings.hpp"
+#include "utils.hpp"
+
+using namespace palloc;
+
+static Uint toLittleEndian(Uint value) noexcept {
+    if constexpr (std::endian::native == std::endian::big) {
+        return std::byteswap(value);
+    }
+
+    return value;
+}
+
+std::unique_ptr<RequestSource> RequestSourceFactory::create(const SimulatorSettings &simSettings,
+                                                            const OutputSettings &outputSettings,
+                                                            size_t dropoffNodes, Uint runNumber,
+                                                            bool resume) {
+    const Uint numberOfRuns = outputSettings.numberOfRunsToAggregate;
+
+    std::unique_ptr<RequestSource> source;
+    if (!simSettings.replayFile.empty()) {
+        // Prefer the recording of the same run and fall back to replaying one file for every run
+        const Path replayPath(simSettings.replayFile);
+        Path runPath = utils::getRunPath(replayPath, runNumber, numberOfRuns);
+        if (!std::filesystem::exists(runPath)) {
+            runPath = replayPath;
+        }
+
+        source = std::make_unique<ReplayRequestSource>(runPath, simSettings.replaySpeed,
+                                                       dropoffNodes);
+    } else {
+        source = std::make_unique<RequestGenerator>(
+            RequestGeneratorOptions{.randomGenerator = simSettings.randomGenerator,
+                                    .dropoffNodes = dropoffNodes,
+                                    .maxTimeTillArrival = simSettings.maxTimeTillArrival,
+                                    .maxRequestDuration = simSettings.maxRequestDuration,
+                                    .seed = simSettings.seed,
+                                    .requestRate = simSettings.requestRate,
+                                    .run = runNumber,
+                                    .commonRandomNumbers = simSettings.commonRandomNumbers,
+                                    .antithetic = simSettings.antithetic});
+    }
+
+    if (!outputSettings.recordPath.empty()) {
+        const Path recordPath =
+            utils::getRunPath(outputSettings.recordPath, runNumber, numberOfRuns);
+        source = std::make_unique<RecordingRequestSource>(std::move(source), recordPath, resume);
+    }
+
+    return source;
+}
+
+ReplayRequestSource::ReplayRequestSource(const Path &recordingPath, Uint speed,
+                                         size_t dropoffNodes)
+    : _input(recordingPath, std::ios::binary),
+      _recordingPath(recordingPath),
+      _dropoffNodes(dropoffNodes),
+      _speed(speed) {
+    if (!_input) {
+        throw std::runtime_error("Failed to open request recording: " + recordingPath.string());
+    }
+
+    if (_speed == 0) {
+        throw std::invalid_argument("Replay speed must be a natural number");
+    }
+
+    std::array<char, 4> magic{};
+    Uint version = 0;
+    _input.read(magic.data(), magic.size());
+    _input.read(reinterpret_cast<char *>(&version), sizeof(version));
+    if (!_input || magic != recording::MAGIC || toLittleEndian(version) != recording::VERSION) {
+        throw std::runtime_error("Not a request recording: " + recordingPath.string());
+    }
+
+    readRecord();
+}
+
+Requests ReplayRequestSource::generate([[maybe_unused]] Uint currentTimeOfDay) {
+    ++_timestep;
+    const Uint64 lastRecordedTimestep = static_cast<Uint64>(_timestep) * _speed;
+
+    Requests requests;
+    while (_nextRecord && _nextRecord->timestep <= lastRecordedTimestep) {
+        const auto &record = *_nextRecord;
+        auto &request = requests.emplace_back(record.dropoff, record.duration, record.arrival);
+        request.setId(_requestsGenerated++);
+        readRecord();
+    }
+
+    return requests;
+}
+
+Uint ReplayRequestSource::getRequestsGenerated() const noexcept { return _requestsGenerated; }
+
+RequestSourceState ReplayRequestSource::getState() const {
+    return {.rngState = 0,
+            .offset = _nextRecordOffset,
+            .timestep = _timestep,
+            .requestsGenerated = _requestsGenerated};
+}
+
+void ReplayRequestSource::setState(const RequestSourceState &state) {
+    _timestep = state.timestep;
+    _requestsGenerated = state.requestsGenerated;
+
+    _input.clear();
+    _input.seekg(static_cast<std::streamoff>(state.offset));
+    _nextRecord.reset();
+    readRecord();
+}
+
+bool ReplayRequestSource::readRecord() {
+    _nextRecordOffset = static_cast<Uint64>(_input.tellg());
+
+    std::array<Uint, 4> fields{};
+    _input.read(reinterpret_cast<char *>(fields.data()), sizeof(fields));
+    if (!_input) {
+        _nextRecord.reset();
+        return false;
+    }
+
+    const recording::Record record{.timestep = toLittleEndian(fields[0]),
+                                   .dropoff = toLittleEndian(fields[1]),
+                                   .duration = toLittleEndian(fields[2]),
+                                   .arrival = toLittleEndian(fields[3])};
+
+    if (record.dropoff >= _dropoffNodes) {
+        throw std::runtime_error("Recorded dropoff " + std::to_string(record.dropoff) +
+                                 " is outside the environment in: " + _recordingPath.string());
+    }
+
+    if (_nextRecord && record.timestep < _nextRecord->timestep) {
+        throw std::runtime_error("Request recording is not sorted by timestep: " +
+                                 _recordingPath.string());
+    }
+
+    _nextRecord = record;
+    return true;
+}
+
+RecordingRequestSource::RecordingRequestSource(std::unique_ptr<RequestSource> source,
+                                               const Path &recordingPath, bool append)
+    : _source(std::move(source)),
+      _output(recordingPath, std::ios::binary | (append ? std::ios::app : std::ios::trunc)),
+      _recordingPath(recordingPath) {
+    if (!_output) {
+        throw std::runtime_error("Failed to open request recording: " + recordingPath.string());
+    }
+
+    if (append) {
+        _offset = std::filesystem::file_size(recordingPath);
+        return;
+    }
+
+    const Uint version = toLittleEndian(recording::VERSION);
+    _output.write(recording::MAGIC.data(), recording::MAGIC.size());
+    _output.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    _offset = recording::MAGIC.size() + sizeof(version);
+}
+
+Requests RecordingRequestSource::generate(Uint currentTimeOfDay) {
+    ++_timestep;
+    Requests requests = _source->generate(currentTimeOfDay);
+    for (const auto &request : requests) {
+        const std::array<Uint, 4> fields{
+            toLittleEndian(_timestep), toLittleEndian(request.getDropoffNode()),
+            toLittleEndian(request.getRequestDuration()), toLittleEndian(request.getArrival())};
+        _output.write(reinterpret_cast<const char *>(fields.data()), sizeof(fields));
+        _offset += sizeof(fields);
+    }
+
+    if (!_output) {
+        throw std::runtime_error("Failed to write request recording: " + _recordingPath.string());
+    }
+
+    return requests;
+}
+
+Uint RecordingRequestSource::getRequestsGenerated() const noexcept {
+    return _source->getRequestsGenerated();
+}
+
+RequestSourceState RecordingRequestSource::getState() const {
+    auto state = _source->getState();
+    state.offset = _offset;
+    state.timestep = _timestep;
+    return state;
+}
+
+void RecordingRequestSource::flush() {
+    _output.flush();
+    if (!_output) {
+        throw std::runtime_error("Failed to write request recording: " + _recordingPath.string());
+    }
+}
+
+void RecordingRequestSource::setState(const RequestSourceState &state) {
+    // Drop everything recorded after the checkpoint so the recording continues seamlessly
+    _output.close();
+    std::filesystem::resize_file(_recordingPath, state.offset);
+    _output.open(_recordingPath, std::ios::binary | std::ios::app);
+    if (!_output) {
+        throw std::runtime_error("Failed to open request recording: " + _recordingPath.string());
+    }
+
+    _offset = state.offset;
+    _timestep = state.timestep;
+    _source->setState(state);
+}
@@ -23,3 +23,13 @@ size_t Result::getRequestsScheduled() const noexcept { return _requestsScheduled
 size_t Result::getRequestsUnassigned() const noexcept { return _requestsUnassigned; }
 
 size_t Result::getProcessedRequests() const noexcept { return _processedRequests; }
+
+size_t Result::getBatches() const noexcept { return _batches; }
+
+size_t Result::getFastPathBatches() const noexcept { return _fastPathBatches; }
+
+const std::optional<RunReport> &Result::getReport() const noexcept { return _report; }
+
+const std::optional<RunMemory> &Result::getMemory() const noexcept { return _memory; }
+
+void Result::setMemory(RunMemory memory) noexcept { _memory = memory; }
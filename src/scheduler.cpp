@@ -1,139 +1,664 @@
 #include "scheduler.hpp"
 
+#include <algorithm>
+#include <bit>
 #include <memory>
+#include <numeric>
+#include <tuple>
+#include <utility>
 
+#include "feasibility_mask.hpp"
 #include "ortools/sat/cp_model.h"
 #include "utils.hpp"
 
 using namespace palloc;
 using namespace operations_research;
 
-SchedulerResult Scheduler::scheduleBatch(Environment &env, Requests &requests,
-                                         const SimulatorSettings &simSettings) {
-    assert(!requests.empty());
+/**
+ * Settings the batch kernels branch on. Runs keep them fixed, so every batch is dispatched once
+ * to a kernel instantiated with them as constants and the common configurations compile without
+ * branches in the inner loops.
+ */
+enum KernelFlag : unsigned {
+    WEIGHTED_PARKING = 1U << 0U,
+    MIN_PARKING_TIME = 1U << 1U,
+    // Some request arrives later, so it may have to wait for the commit interval
+    EARLY_REQUESTS = 1U << 2U,
+    ALL_FLAGS = (1U << 3U) - 1,
+};
 
-    sat::CpModelBuilder cpModel;
+template <unsigned Mask>
+struct FixedFlags {
+    static constexpr bool useWeightedParking() noexcept { return (Mask & WEIGHTED_PARKING) != 0; }
+    static constexpr bool hasMinParkingTime() noexcept { return (Mask & MIN_PARKING_TIME) != 0; }
+    static constexpr bool hasEarlyRequests() noexcept { return (Mask & EARLY_REQUESTS) != 0; }
+};
+
+/**
+ * Flags read at runtime, the generic kernel the fixed ones are benchmarked against
+ */
+struct RuntimeFlags {
+    unsigned mask;
+
+    bool useWeightedParking() const noexcept { return (mask & WEIGHTED_PARKING) != 0; }
+    bool hasMinParkingTime() const noexcept { return (mask & MIN_PARKING_TIME) != 0; }
+    bool hasEarlyRequests() const noexcept { return (mask & EARLY_REQUESTS) != 0; }
+};
+
+static unsigned getKernelFlags(const SimulatorSettings &simSettings) {
+    unsigned mask = 0;
+    mask |= simSettings.useWeightedParking ? WEIGHTED_PARKING : 0U;
+    mask |= simSettings.minParkingTime > 0 ? MIN_PARKING_TIME : 0U;
+    return mask;
+}
+
+/**
+ * Call the function with the fixed flags of the mask
+ */
+template <unsigned Mask = 0, typename Function>
+static decltype(auto) dispatchFlags(unsigned mask, Function &&function) {
+    if constexpr (Mask == ALL_FLAGS) {
+        return function(FixedFlags<Mask>{});
+    } else {
+        if (mask == Mask) {
+            return function(FixedFlags<Mask>{});
+        }
+
+        return dispatchFlags<Mask + 1>(mask, std::forward<Function>(function));
+    }
+}
+
+template <typename Flags>
+static Candidates fillCandidates(const Environment &env, const Requests &requests,
+                                 Uint minParkingTime, std::pmr::memory_resource *resource,
+                                 Flags flags) {
+    const auto &travelTimes = *env.getTravelTimes();
+
+    Candidates candidates(requests.size(), resource);
+    FeasibilityMask::Words feasible(resource);
+    // The row entries inside the reachable cells and their legs, gathered for the mask
+    SpatialIndex::Indices reachable(resource);
+    std::pmr::vector<size_t> entries(resource);
+    std::pmr::vector<TravelTimes::Duration> toParking(resource);
+    std::pmr::vector<TravelTimes::Duration> toDropoff(resource);
+    const bool canPrune = env.canPruneParkings();
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const auto dropoffNode = requests[i].getDropoffNode();
+        const auto requestDuration = requests[i].getRequestDuration();
+        if (flags.hasMinParkingTime() && requestDuration < minParkingTime) {
+            continue;
+        }
+
+        // If travel time longer than request duration it cannot be assigned from r -> p
+        const Uint budget =
+            flags.hasMinParkingTime() ? requestDuration - minParkingTime : requestDuration;
+        const auto row = travelTimes.getRow(dropoffNode);
+        if (canPrune) {
+            env.getReachableParkings(dropoffNode, budget, reachable);
+        }
+
+        // Only entries inside the reachable cells are masked, unless they cover the whole row.
+        // Both are in ascending parking order, so the set bits are too
+        const bool pruned = canPrune && reachable.size() < row.parkings.size();
+        if (pruned) {
+            entries.clear();
+            toParking.clear();
+            toDropoff.clear();
+            for (const auto j : reachable) {
+                if (const auto entry = row.find(j)) {
+                    entries.push_back(*entry);
+                    toParking.push_back(row.toParking[*entry]);
+                    toDropoff.push_back(row.toDropoff[*entry]);
+                }
+            }
+
+            FeasibilityMask::compute(toParking, toDropoff, budget, feasible);
+        } else {
+            FeasibilityMask::compute(row.toParking, row.toDropoff, budget, feasible);
+        }
+
+        for (size_t w = 0; w < feasible.size(); ++w) {
+            for (Uint64 word = feasible[w]; word != 0; word &= word - 1) {
+                const size_t bit = w * 64 + static_cast<size_t>(std::countr_zero(word));
+                const size_t entry = pruned ? entries[bit] : bit;
+                const Int64 cost = flags.useWeightedParking() ? env.getCost(row, entry, true)
+                                                              : Int64{row.getRoundTrip(entry)};
+                candidates[i].push_back({.parkingNode = row.parkings[entry], .cost = cost});
+            }
+        }
+    }
+
+    return candidates;
+}
 
-    const auto &parkingToDropoff = env.getParkingToDropoff();
-    const auto &dropoffToParking = env.getDropoffToParking();
+Candidates Scheduler::getCandidates(const Environment &env, const Requests &requests,
+                                    const SimulatorSettings &simSettings,
+                                    std::pmr::memory_resource *resource) {
+    return dispatchFlags(getKernelFlags(simSettings), [&](auto flags) {
+        return fillCandidates(env, requests, simSettings.minParkingTime, resource, flags);
+    });
+}
+
+Int64 Scheduler::getPenalty(const Request &request) {
+    const auto dropFactor = 1 + request.getTimesDropped();
+    return static_cast<Int64>(UNASSIGNED_PENALTY) * dropFactor;
+}
+
+Uint Scheduler::getUnreservedSpots(Uint availableSpots, Uint reservedSpots) noexcept {
+    return availableSpots > reservedSpots ? availableSpots - reservedSpots : 0;
+}
+
+GreedyAssignment Scheduler::assignGreedily(const Environment &env, const Requests &requests,
+                                           const Candidates &candidates,
+                                           const SchedulerContext &context) {
     const auto numberOfParkings = env.getNumberOfParkings();
+    const auto &availableParkingSpots = env.getAvailableParkingSpots();
     const auto requestCount = requests.size();
-    auto &availableParkingSpots = env.getAvailableParkingSpots();
+    auto *resource = candidates.get_allocator().resource();
 
-    const auto commitInterval = simSettings.commitInterval;
+    GreedyAssignment greedy{
+        .parkingNodes = std::pmr::vector<std::optional<Uint>>(requestCount, resource),
+        .lowerBound = 0,
+        .isOptimal = true};
 
-    // Binary variables from request to parkings
-    std::vector<std::vector<sat::BoolVar>> var(requestCount);
+    // Reservations only cost something once a parking is claimed past them
+    std::pmr::vector<Uint> claimedSpots(context.reservedSpots.begin(), context.reservedSpots.end(),
+                                        resource);
+    claimedSpots.resize(numberOfParkings, 0);
     for (size_t i = 0; i < requestCount; ++i) {
-        var[i].reserve(numberOfParkings);
-        for (size_t j = 0; j < numberOfParkings; ++j) {
-            var[i].push_back(cpModel.NewBoolVar());
+        Int64 bestCost = getPenalty(requests[i]);
+        std::optional<Uint> bestParking;
+        for (const auto &candidate : candidates[i]) {
+            if (candidate.cost < bestCost || (!bestParking && candidate.cost == bestCost)) {
+                bestCost = candidate.cost;
+                bestParking = candidate.parkingNode;
+            }
+        }
+
+        greedy.lowerBound += bestCost;
+        greedy.parkingNodes[i] = bestParking;
+        if (!bestParking) {
+            continue;
+        }
+
+        // The timeline checks capacity over time below, but reserved spots are always counted
+        // against the spots free now
+        const auto parkingNode = *bestParking;
+        const bool isReserved =
+            parkingNode < context.reservedSpots.size() && context.reservedSpots[parkingNode] > 0;
+        if (++claimedSpots[parkingNode] > availableParkingSpots[parkingNode] &&
+            (context.timeline == nullptr || isReserved)) {
+            greedy.isOptimal = false;
         }
     }
 
-    // Respect parking lot capacity
-    for (size_t j = 0; j < numberOfParkings; ++j) {
-        std::vector<sat::BoolVar> colVars;
-        colVars.reserve(requestCount);
+    // Spots only have to be free while each request occupies them
+    if (context.timeline != nullptr) {
+        std::pmr::vector<std::pmr::vector<OccupancyInterval>> intervals(numberOfParkings, resource);
         for (size_t i = 0; i < requestCount; ++i) {
-            colVars.push_back(var[i][j]);
+            const auto parkingNode = greedy.parkingNodes[i];
+            if (parkingNode) {
+                intervals[*parkingNode].push_back(
+                    getOccupancyInterval(env, requests[i], i, *parkingNode, *context.timeline));
+            }
         }
 
-        cpModel.AddLessOrEqual(sat::LinearExpr::Sum(colVars), availableParkingSpots[j]);
+        for (size_t j = 0; j < numberOfParkings && greedy.isOptimal; ++j) {
+            const Uint reservedSpots = j < context.reservedSpots.size()
+                                           ? std::min(context.reservedSpots[j],
+                                                      availableParkingSpots[j])
+                                           : 0;
+            const auto windows = context.timeline->getCapacityWindows(
+                j, availableParkingSpots[j] - reservedSpots, intervals[j]);
+            greedy.isOptimal = windows.empty();
+        }
     }
 
-    // If travel time longer than request duration it cannot be assigned from r -> p
-    const auto minParkingTime = simSettings.minParkingTime;
-    for (size_t i = 0; i < requestCount; ++i) {
-        const auto dropoffNode = requests[i].getDropoffNode();
-        const auto requestDuration = requests[i].getRequestDuration();
-        for (size_t j = 0; j < numberOfParkings; ++j) {
-            const auto travelTime =
-                (parkingToDropoff[j][dropoffNode] + dropoffToParking[dropoffNode][j]);
-            if (travelTime + minParkingTime > requestDuration) {
-                cpModel.AddEquality(var[i][j], 0);
-            }
+    return greedy;
+}
+
+Int64 Scheduler::getObjective(const Environment &env, const Requests &requests,
+                              const Candidates &candidates,
+                              std::span<const std::optional<Uint>> parkingNodes,
+                              const SchedulerContext &context) {
+    const auto &availableParkingSpots = env.getAvailableParkingSpots();
+    std::pmr::vector<Uint> usedSpots(env.getNumberOfParkings(), 0,
+                                     candidates.get_allocator().resource());
+
+    Int64 objective = 0;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (!parkingNodes[i]) {
+            objective += getPenalty(requests[i]);
+            continue;
+        }
+
+        const auto parkingNode = *parkingNodes[i];
+        const auto candidate =
+            std::ranges::find(candidates[i], parkingNode, &Candidate::parkingNode);
+        assert(candidate != candidates[i].end());
+        objective += candidate->cost;
+        ++usedSpots[parkingNode];
+    }
+
+    const auto &reservedSpots = context.reservedSpots;
+    for (size_t j = 0; j < reservedSpots.size(); ++j) {
+        if (reservedSpots[j] == 0) {
+            continue;
+        }
+
+        const auto unreservedSpots = getUnreservedSpots(availableParkingSpots[j], reservedSpots[j]);
+        if (usedSpots[j] > unreservedSpots) {
+            objective += static_cast<Int64>(RESERVATION_PENALTY) * (usedSpots[j] - unreservedSpots);
+        }
+    }
+
+    return objective;
+}
+
+OccupancyInterval Scheduler::getOccupancyInterval(const Environment &env, const Request &request,
+                                                  size_t requestIndex, size_t parkingNode,
+                                                  const OccupancyTimeline &timeline) {
+    const auto timestep = timeline.getTimestep();
+    const auto tillArrival = request.getArrival();
+    const auto timeToDrive =
+        env.getParkingToDropoff(static_cast<Uint>(parkingNode), request.getDropoffNode());
+    const auto release = OccupancyTimeline::getReleaseTimestep(
+        timestep, tillArrival, request.getRequestDuration(), timeToDrive);
+    return {.request = requestIndex, .start = timestep + tillArrival, .end = release};
+}
+
+static sat::CpSolverResponse solveModel(const sat::CpModelBuilder &cpModel) {
+    sat::Model model;
+    sat::SatParameters parameters;
+    parameters.set_max_time_in_seconds(Scheduler::MAX_SEARCH_TIME);
+    parameters.set_num_search_workers(1);
+    model.Add(sat::NewSatParameters(parameters));
+
+    return sat::SolveCpModel(cpModel.Build(), &model);
+}
+
+static bool isSolved(const sat::CpSolverResponse &response) {
+    return response.status() == sat::CpSolverStatus::OPTIMAL ||
+           response.status() == sat::CpSolverStatus::FEASIBLE;
+}
+
+/**
+ * Group requests which are interchangeable for the model: same dropoff, same feasible parkings
+ * and same penalty, and with a timeline the same occupancy of a spot. Returns the request indices
+ * ordered by class together with the offset of every class, earliest arrivals first in a class.
+ */
+static std::pair<std::pmr::vector<size_t>, std::pmr::vector<size_t>> groupRequests(
+    const Requests &requests, const Candidates &candidates, bool useTimeline) {
+    auto *resource = candidates.get_allocator().resource();
+
+    const auto getKey = [&](size_t i) {
+        const auto &request = requests[i];
+        return std::tuple(request.getDropoffNode(), request.getTimesDropped(),
+                          useTimeline ? request.getRequestDuration() : 0,
+                          useTimeline ? request.getArrival() : 0);
+    };
+
+    const auto isEquivalent = [&](size_t a, size_t b) {
+        return getKey(a) == getKey(b) &&
+               std::ranges::equal(candidates[a], candidates[b], {}, &Candidate::parkingNode,
+                                  &Candidate::parkingNode);
+    };
+
+    std::pmr::vector<size_t> order(requests.size(), resource);
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::sort(order, [&](size_t a, size_t b) {
+        if (getKey(a) != getKey(b)) {
+            return getKey(a) < getKey(b);
+        }
+
+        if (!std::ranges::equal(candidates[a], candidates[b], {}, &Candidate::parkingNode,
+                                &Candidate::parkingNode)) {
+            return std::ranges::lexicographical_compare(
+                candidates[a], candidates[b], {}, &Candidate::parkingNode, &Candidate::parkingNode);
+        }
+
+        return std::pair(requests[a].getArrival(), a) < std::pair(requests[b].getArrival(), b);
+    });
+
+    std::pmr::vector<size_t> classStarts(resource);
+    for (size_t k = 0; k < order.size(); ++k) {
+        if (k == 0 || !isEquivalent(order[k - 1], order[k])) {
+            classStarts.push_back(k);
         }
     }
 
-    // All request have at most 1 parking spot or are unassigned
-    std::vector<sat::BoolVar> unassignedVars(requestCount);
+    classStarts.push_back(order.size());
+    return {std::move(order), std::move(classStarts)};
+}
+
+ModelSolution Scheduler::solveRequestModel(const Environment &env, const Requests &requests,
+                                           const Candidates &candidates,
+                                           const SchedulerContext &context) {
+    auto *resource = candidates.get_allocator().resource();
+    const auto numberOfParkings = env.getNumberOfParkings();
+    const auto requestCount = requests.size();
+    const auto &availableParkingSpots = env.getAvailableParkingSpots();
+
+    sat::CpModelBuilder cpModel;
+    ModelSolution solution{.parkingNodes = std::pmr::vector<std::optional<Uint>>(resource),
+                           .variableCount = 0,
+                           .solved = false};
+
+    size_t candidateCount = 0;
+    for (const auto &requestCandidates : candidates) {
+        candidateCount += requestCandidates.size();
+    }
+
+    std::pmr::vector<sat::BoolVar> objectiveVars(resource);
+    std::pmr::vector<int64_t> objectiveCoeffs(resource);
+    objectiveVars.reserve(candidateCount + requestCount);
+    objectiveCoeffs.reserve(candidateCount + requestCount);
+
+    // Binary variables from request to its feasible parkings
+    std::pmr::vector<std::pmr::vector<sat::BoolVar>> var(requestCount, resource);
+    std::pmr::vector<std::pmr::vector<sat::BoolVar>> parkingVars(numberOfParkings, resource);
+    std::pmr::vector<std::pmr::vector<size_t>> parkingRequests(numberOfParkings, resource);
+    std::pmr::vector<sat::BoolVar> combinedVars(resource);
     for (size_t i = 0; i < requestCount; ++i) {
-        unassignedVars[i] = cpModel.NewBoolVar();
+        const auto unassignedVar = cpModel.NewBoolVar();
+        objectiveVars.push_back(unassignedVar);
+        objectiveCoeffs.push_back(getPenalty(requests[i]));
 
-        std::vector<sat::BoolVar> combinedVars;
-        combinedVars.reserve(numberOfParkings);
-        combinedVars.push_back(unassignedVars[i]);
-        for (size_t j = 0; j < numberOfParkings; ++j) {
-            combinedVars.push_back(var[i][j]);
+        combinedVars.clear();
+        combinedVars.push_back(unassignedVar);
+
+        var[i].reserve(candidates[i].size());
+        for (const auto &candidate : candidates[i]) {
+            const auto parkingVar = cpModel.NewBoolVar();
+            var[i].push_back(parkingVar);
+            combinedVars.push_back(parkingVar);
+            parkingVars[candidate.parkingNode].push_back(parkingVar);
+            parkingRequests[candidate.parkingNode].push_back(i);
+            objectiveVars.push_back(parkingVar);
+            objectiveCoeffs.push_back(candidate.cost);
         }
 
+        // All request have at most 1 parking spot or are unassigned
         cpModel.AddEquality(sat::LinearExpr::Sum(combinedVars), 1);
     }
 
+    // Respect parking lot capacity
+    std::pmr::vector<OccupancyInterval> intervals(resource);
+    std::pmr::vector<sat::BoolVar> windowVars(resource);
+    for (size_t j = 0; j < numberOfParkings; ++j) {
+        const auto &colVars = parkingVars[j];
+        if (context.timeline != nullptr) {
+            // Requests only compete for a spot while their occupancies overlap
+            intervals.clear();
+            for (size_t k = 0; k < colVars.size(); ++k) {
+                const auto &request = requests[parkingRequests[j][k]];
+                intervals.push_back(getOccupancyInterval(env, request, k, j, *context.timeline));
+            }
+
+            const auto windows =
+                context.timeline->getCapacityWindows(j, availableParkingSpots[j], intervals);
+            for (const auto &window : windows) {
+                windowVars.clear();
+                for (const auto k : window.requests) {
+                    windowVars.push_back(colVars[k]);
+                }
+
+                cpModel.AddLessOrEqual(sat::LinearExpr::Sum(windowVars), window.freeSpots);
+            }
+        } else if (colVars.size() > availableParkingSpots[j]) {
+            cpModel.AddLessOrEqual(sat::LinearExpr::Sum(colVars), availableParkingSpots[j]);
+        }
+    }
+
     // Minimize global cost of all requests
-    sat::LinearExpr objective;
-    const bool useWeightedParking = simSettings.useWeightedParking;
-    for (size_t i = 0; i < requestCount; ++i) {
-        const auto dropoffNode = requests[i].getDropoffNode();
-        const auto dropFactor = 1 + requests[i].getTimesDropped();
-        const auto penalty = UNASSIGNED_PENALTY * dropFactor;
-        objective += penalty * sat::LinearExpr(unassignedVars[i]);
-        for (size_t j = 0; j < numberOfParkings; ++j) {
-            double cost = dropoffToParking[dropoffNode][j] + parkingToDropoff[j][dropoffNode];
-            if (useWeightedParking) {
-                const auto &parkingWeights = env.getParkingWeights();
-                assert(parkingWeights[j] >= 0.0 && parkingWeights[j] <= 2.0);
-                cost *= parkingWeights[j];
+    sat::LinearExpr objective = sat::LinearExpr::WeightedSum(objectiveVars, objectiveCoeffs);
+
+    // Penalize every spot taken from future requests
+    const auto &reservedSpots = context.reservedSpots;
+    for (size_t j = 0; j < reservedSpots.size(); ++j) {
+        if (reservedSpots[j] == 0 || parkingVars[j].empty()) {
+            continue;
+        }
+
+        const sat::IntVar overflowVar =
+            cpModel.NewIntVar(Domain(0, static_cast<Int64>(parkingVars[j].size())));
+
+        const Int64 unreservedSpots =
+            getUnreservedSpots(availableParkingSpots[j], reservedSpots[j]);
+        cpModel.AddLessOrEqual(sat::LinearExpr::Sum(parkingVars[j]) - overflowVar,
+                               unreservedSpots);
+        objective += RESERVATION_PENALTY * sat::LinearExpr(overflowVar);
+        ++solution.variableCount;
+    }
+
+    cpModel.Minimize(objective);
+    const auto response = solveModel(cpModel);
+
+    solution.solved = isSolved(response);
+    solution.parkingNodes.resize(requestCount);
+    if (solution.solved) {
+        for (size_t i = 0; i < requestCount; ++i) {
+            for (size_t k = 0; k < var[i].size(); ++k) {
+                if (sat::SolutionBooleanValue(response, var[i][k])) {
+                    solution.parkingNodes[i] = candidates[i][k].parkingNode;
+                    break;
+                }
             }
+        }
+    }
+
+    solution.variableCount += requestCount + candidateCount;
+    return solution;
+}
+
+ModelSolution Scheduler::solveClassModel(const Environment &env, const Requests &requests,
+                                         const Candidates &candidates,
+                                         const SchedulerContext &context) {
+    auto *resource = candidates.get_allocator().resource();
+    const auto numberOfParkings = env.getNumberOfParkings();
+    const auto &availableParkingSpots = env.getAvailableParkingSpots();
+
+    sat::CpModelBuilder cpModel;
+    ModelSolution solution{.parkingNodes = std::pmr::vector<std::optional<Uint>>(resource),
+                           .variableCount = 0,
+                           .solved = false};
+
+    const auto [order, classStarts] =
+        groupRequests(requests, candidates, context.timeline != nullptr);
+    const auto classCount = classStarts.size() - 1;
+
+    std::pmr::vector<sat::IntVar> objectiveVars(resource);
+    std::pmr::vector<int64_t> objectiveCoeffs(resource);
+
+    // Number of requests of a class in each of its feasible parkings
+    std::pmr::vector<std::pmr::vector<sat::IntVar>> flow(classCount, resource);
+    std::pmr::vector<std::pmr::vector<sat::IntVar>> parkingVars(numberOfParkings, resource);
+    std::pmr::vector<std::pmr::vector<size_t>> parkingClasses(numberOfParkings, resource);
+    std::pmr::vector<Int64> parkingDemand(numberOfParkings, 0, resource);
+    std::pmr::vector<sat::IntVar> combinedVars(resource);
+    for (size_t c = 0; c < classCount; ++c) {
+        const auto &request = requests[order[classStarts[c]]];
+        const auto &classCandidates = candidates[order[classStarts[c]]];
+        const auto classSize = static_cast<Int64>(classStarts[c + 1] - classStarts[c]);
 
-            objective += std::lround(cost) * sat::LinearExpr(var[i][j]);
+        const auto unassignedVar = cpModel.NewIntVar(Domain(0, classSize));
+        objectiveVars.push_back(unassignedVar);
+        objectiveCoeffs.push_back(getPenalty(request));
+
+        combinedVars.clear();
+        combinedVars.push_back(unassignedVar);
+
+        flow[c].reserve(classCandidates.size());
+        for (const auto &candidate : classCandidates) {
+            const auto flowVar = cpModel.NewIntVar(Domain(0, classSize));
+            flow[c].push_back(flowVar);
+            combinedVars.push_back(flowVar);
+            parkingVars[candidate.parkingNode].push_back(flowVar);
+            parkingClasses[candidate.parkingNode].push_back(c);
+            parkingDemand[candidate.parkingNode] += classSize;
+            objectiveVars.push_back(flowVar);
+            objectiveCoeffs.push_back(candidate.cost);
         }
+
+        // Every request of the class is either parked or unassigned
+        cpModel.AddEquality(sat::LinearExpr::Sum(combinedVars), classSize);
+        solution.variableCount += combinedVars.size();
+    }
+
+    // Respect parking lot capacity
+    std::pmr::vector<OccupancyInterval> intervals(resource);
+    std::pmr::vector<sat::IntVar> windowVars(resource);
+    for (size_t j = 0; j < numberOfParkings; ++j) {
+        const auto &colVars = parkingVars[j];
+        if (context.timeline != nullptr) {
+            // One interval per request, so windows know how many requests they cover
+            intervals.clear();
+            for (size_t k = 0; k < colVars.size(); ++k) {
+                const auto c = parkingClasses[j][k];
+                const auto interval =
+                    getOccupancyInterval(env, requests[order[classStarts[c]]], k, j,
+                                         *context.timeline);
+                intervals.insert(intervals.end(), classStarts[c + 1] - classStarts[c], interval);
+            }
+
+            const auto windows =
+                context.timeline->getCapacityWindows(j, availableParkingSpots[j], intervals);
+            for (const auto &window : windows) {
+                windowVars.clear();
+                for (size_t w = 0; w < window.requests.size(); ++w) {
+                    if (w == 0 || window.requests[w] != window.requests[w - 1]) {
+                        windowVars.push_back(colVars[window.requests[w]]);
+                    }
+                }
+
+                cpModel.AddLessOrEqual(sat::LinearExpr::Sum(windowVars), window.freeSpots);
+            }
+        } else if (parkingDemand[j] > static_cast<Int64>(availableParkingSpots[j])) {
+            cpModel.AddLessOrEqual(sat::LinearExpr::Sum(colVars), availableParkingSpots[j]);
+        }
+    }
+
+    // Minimize global cost of all requests
+    sat::LinearExpr objective = sat::LinearExpr::WeightedSum(objectiveVars, objectiveCoeffs);
+
+    // Penalize every spot taken from future requests
+    const auto &reservedSpots = context.reservedSpots;
+    for (size_t j = 0; j < reservedSpots.size(); ++j) {
+        if (reservedSpots[j] == 0 || parkingVars[j].empty()) {
+            continue;
+        }
+
+        const sat::IntVar overflowVar = cpModel.NewIntVar(Domain(0, parkingDemand[j]));
+
+        const Int64 unreservedSpots =
+            getUnreservedSpots(availableParkingSpots[j], reservedSpots[j]);
+        cpModel.AddLessOrEqual(sat::LinearExpr::Sum(parkingVars[j]) - overflowVar,
+                               unreservedSpots);
+        objective += RESERVATION_PENALTY * sat::LinearExpr(overflowVar);
+        ++solution.variableCount;
     }
 
     cpModel.Minimize(objective);
+    const auto response = solveModel(cpModel);
 
-    sat::Model model;
-    sat::SatParameters parameters;
-    parameters.set_max_time_in_seconds(MAX_SEARCH_TIME);
-    parameters.set_num_search_workers(1);
-    model.Add(sat::NewSatParameters(parameters));
+    solution.solved = isSolved(response);
+    solution.parkingNodes.resize(requests.size());
+    if (solution.solved) {
+        // Hand out the parkings of every class in order, the earliest arrivals are parked first
+        for (size_t c = 0; c < classCount; ++c) {
+            const auto &classCandidates = candidates[order[classStarts[c]]];
+            auto member = classStarts[c];
+            for (size_t k = 0; k < flow[c].size(); ++k) {
+                const auto parked = sat::SolutionIntegerValue(response, flow[c][k]);
+                for (Int64 n = 0; n < parked; ++n) {
+                    solution.parkingNodes[order[member++]] = classCandidates[k].parkingNode;
+                }
+            }
+        }
+    }
+
+    return solution;
+}
 
-    const sat::CpSolverResponse response = sat::SolveCpModel(cpModel.Build(), &model);
+SchedulerResult Scheduler::scheduleBatch(Environment &env, Requests &requests,
+                                         const SimulatorSettings &simSettings,
+                                         const SchedulerContext &context) {
+    assert(!requests.empty());
+
+    unsigned mask = getKernelFlags(simSettings);
+    // Arrivals are checked on the requests themselves, replayed requests may ignore the settings
+    const bool hasEarlyRequests = std::ranges::any_of(
+        requests, [](const Request &request) { return request.getArrival() > 0; });
+    mask |= hasEarlyRequests ? EARLY_REQUESTS : 0U;
+
+    if (context.genericKernels) {
+        return runBatchKernel(env, requests, simSettings, context, RuntimeFlags{mask});
+    }
+
+    return dispatchFlags(mask, [&](auto flags) {
+        return runBatchKernel(env, requests, simSettings, context, flags);
+    });
+}
+
+template <typename Flags>
+SchedulerResult Scheduler::runBatchKernel(Environment &env, Requests &requests,
+                                          const SimulatorSettings &simSettings,
+                                          const SchedulerContext &context, Flags flags) {
+    const auto requestCount = requests.size();
+    auto &availableParkingSpots = env.getAvailableParkingSpots();
+
+    const auto commitInterval = simSettings.commitInterval;
+    const auto &backend = simSettings.schedulerBackend;
+
+    // Scratch containers live until the end of the batch, only the result outlives it
+    auto *resource =
+        context.arena != nullptr ? context.arena->getResource() : std::pmr::get_default_resource();
+
+    // Without contention every request simply takes its cheapest parking
+    const auto candidates =
+        fillCandidates(env, requests, simSettings.minParkingTime, resource, flags);
+
+    auto greedy = assignGreedily(env, requests, candidates, context);
+    const bool useFastPath = greedy.isOptimal && backend != "cp-sat" && backend != "aggregated";
+    ModelSolution solution{
+        .parkingNodes = std::move(greedy.parkingNodes), .variableCount = 0, .solved = true};
+    if (!useFastPath) {
+        solution = backend == "cp-sat" ? solveRequestModel(env, requests, candidates, context)
+                                       : solveClassModel(env, requests, candidates, context);
+    }
+
+    const auto &parkingNodes = solution.parkingNodes;
+    const bool solved = solution.solved;
+    const Int64 objective =
+        solved ? getObjective(env, requests, candidates, parkingNodes, context) : 0;
 
     Simulations simulations;
     Requests unassignedRequests;
     Requests earlyRequests;
 
-    if (response.status() == sat::CpSolverStatus::OPTIMAL ||
-        response.status() == sat::CpSolverStatus::FEASIBLE) {
+    // With a timeline early requests are committed right away and claim their spot on arrival
+    const bool commitAll = context.timeline != nullptr;
+    if (solved) {
         for (size_t i = 0; i < requestCount; ++i) {
             auto &request = requests[i];
-            size_t parkingNode = 0;
-            bool assigned = false;
             const auto dropoffNode = request.getDropoffNode();
             const auto requestDuration = request.getRequestDuration();
             const auto tillArrival = request.getArrival();
-            Uint routeDuration = 0;
-
-            for (size_t j = 0; j < numberOfParkings; ++j) {
-                if (sat::SolutionBooleanValue(response, var[i][j])) {
-                    parkingNode = j;
-                    assigned = true;
-                    routeDuration = dropoffToParking[dropoffNode][parkingNode] +
-                                    parkingToDropoff[parkingNode][dropoffNode];
-                    break;
-                }
-            }
 
-            if (tillArrival > commitInterval) {
+            if (flags.hasEarlyRequests() && tillArrival > commitInterval && !commitAll) {
                 earlyRequests.push_back(request);
-            } else if (assigned) {
-                --availableParkingSpots[parkingNode];
+            } else if (parkingNodes[i]) {
+                const auto parkingNode = *parkingNodes[i];
+                const Uint routeDuration = env.getRoundTrip(dropoffNode, parkingNode);
+                const bool pendingClaim = flags.hasEarlyRequests() && commitAll && tillArrival > 0;
+                if (!pendingClaim) {
+                    --availableParkingSpots[parkingNode];
+                }
+
                 simulations.emplace_back(dropoffNode, parkingNode, requestDuration, tillArrival,
-                                         routeDuration);
+                                         routeDuration, request.getId(), pendingClaim);
             } else {
-                if (tillArrival > 0) {
+                if (flags.hasEarlyRequests() && tillArrival > 0) {
                     earlyRequests.push_back(request);
                 } else {
                     request.incrementTimesDropped();
@@ -144,14 +669,18 @@ SchedulerResult Scheduler::scheduleBatch(Environment &env, Requests &requests,
     }
 
     Uint sumDuration = 0;
-    DoubleVector costVec;
+    std::pmr::vector<double> costVec(resource);
     size_t processedRequests = simulations.size() + unassignedRequests.size();
     costVec.reserve(processedRequests);
+    const auto &parkingWeights = env.getParkingWeights();
     for (const auto &simulation : simulations) {
-        sumDuration += simulation.getRouteDuration();
-        costVec.push_back(
-            simulation.getRouteDuration() *
-            (useWeightedParking ? env.getParkingWeights()[simulation.getParkingNode()] : 1.0));
+        const auto routeDuration = simulation.getRouteDuration();
+        sumDuration += routeDuration;
+        if (flags.useWeightedParking()) {
+            costVec.push_back(routeDuration * parkingWeights[simulation.getParkingNode()]);
+        } else {
+            costVec.push_back(routeDuration);
+        }
     }
 
     for (const auto &request : unassignedRequests) {
@@ -159,8 +688,7 @@ SchedulerResult Scheduler::scheduleBatch(Environment &env, Requests &requests,
     }
 
     double sumCost = utils::KahanSum(costVec);
-    size_t variableCount = requestCount * (numberOfParkings + 1);
 
-    return {simulations, unassignedRequests, earlyRequests, sumDuration,
-            sumCost,     processedRequests,  variableCount};
+    return {simulations,       unassignedRequests, earlyRequests, sumDuration, sumCost,
+            processedRequests, solution.variableCount, useFastPath, objective};
 }
\ No newline at end of file
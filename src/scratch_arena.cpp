@@ -0,0 +1,41 @@
+#include "scratch_arena.hpp"
+
+using namespace palloc;
+
+ScratchArena::ScratchArena(size_t initialCapacity) : _buffer(initialCapacity) {
+    _resource.emplace(_buffer.data(), _buffer.size(), &_upstream);
+}
+
+std::pmr::memory_resource *ScratchArena::getResource() noexcept { return &*_resource; }
+
+void ScratchArena::reset() {
+    _resource.reset();
+
+    // Grow by what overflowed so the same batch fits the buffer next time
+    if (_upstream.bytesSinceReset > 0) {
+        _buffer = std::vector<std::byte>(_buffer.size() + _upstream.bytesSinceReset);
+        _upstream.bytesSinceReset = 0;
+    }
+
+    _resource.emplace(_buffer.data(), _buffer.size(), &_upstream);
+}
+
+size_t ScratchArena::getUpstreamAllocations() const noexcept { return _upstream.allocations; }
+
+size_t ScratchArena::getCapacity() const noexcept { return _buffer.size(); }
+
+void *ScratchArena::CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    ++allocations;
+    bytesSinceReset += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void ScratchArena::CountingResource::do_deallocate(void *pointer, size_t bytes,
+                                                   size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+}
+
+bool ScratchArena::CountingResource::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
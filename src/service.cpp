@@ -0,0 +1,312 @@
+#include "service.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <print>
+#include <thread>
+
+#include "request_generator.hpp"
+#include "scheduler.hpp"
+
+using namespace palloc;
+
+void Service::writeLine(const auto &value, std::ostream &out) {
+    std::string buffer;
+    const auto error = glz::write_json(value, buffer);
+    if (error) {
+        throw std::runtime_error("Failed to serialize service response");
+    }
+
+    out << buffer << '\n';
+    out.flush();
+}
+
+Service::Service(Environment env, SimulatorSettings simSettings, ServiceSettings serviceSettings)
+    : _env(std::move(env)),
+      _simSettings(std::move(simSettings)),
+      _serviceSettings(serviceSettings) {}
+
+void Service::serve(Environment &env, const SimulatorSettings &simSettings,
+                    const ServiceSettings &serviceSettings) {
+    Service service(env, simSettings, serviceSettings);
+
+    // Reader thread parses lines so the service loop can wake up on the batching deadline
+    std::thread reader([&service]() {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (line.empty()) {
+                continue;
+            }
+
+            ServiceMessage message;
+            const auto error = glz::read_json(message, line);
+            if (error) {
+                // Responses are owned by the service loop so parse errors go to stderr
+                std::println(stderr, "Error: Failed to parse message: {}",
+                             glz::format_error(error, line));
+                continue;
+            }
+
+            service.submit(std::move(message));
+        }
+
+        service.submit({.type = "shutdown"});
+    });
+
+    service.run(std::cout);
+    reader.join();
+
+    const auto stats = service.getStats();
+    std::println(stderr, "Served {} requests in {} batches", stats.requestsReceived,
+                 stats.batchesSolved);
+}
+
+void Service::benchmark(Environment &env, const SimulatorSettings &simSettings,
+                        const ServiceSettings &serviceSettings) {
+    Service service(env, simSettings, serviceSettings);
+
+    RequestGenerator generator({.randomGenerator = simSettings.randomGenerator,
+                                .dropoffNodes = env.getNumberOfDropoffs(),
+                                .maxTimeTillArrival = simSettings.maxTimeTillArrival,
+                                .maxRequestDuration = simSettings.maxRequestDuration,
+                                .seed = simSettings.seed,
+                                .requestRate = simSettings.requestRate});
+
+    std::println("Replaying {} timesteps of generated requests through the service...",
+                 simSettings.timesteps);
+
+    std::ostream discard(nullptr);
+    std::thread server([&service, &discard]() { service.run(discard); });
+
+    for (Uint timestep = 1; timestep <= simSettings.timesteps; ++timestep) {
+        const Uint currentTimeOfDay = (simSettings.startTime + timestep - 1) % 1440;
+        for (const auto &request : generator.generate(currentTimeOfDay)) {
+            service.submit({.type = "request",
+                            .id = request.getId(),
+                            .dropoff = request.getDropoffNode(),
+                            .duration = request.getRequestDuration(),
+                            .arrival = request.getArrival()});
+        }
+
+        service.submit({.type = "advance", .minutes = 1});
+    }
+
+    service.submit({.type = "shutdown"});
+    server.join();
+
+    const auto stats = service.getStats();
+    std::println("Requests received: {}", stats.requestsReceived);
+    std::println("Requests assigned: {}", stats.requestsAssigned);
+    std::println("Batches solved: {}", stats.batchesSolved);
+    std::println("Elapsed: {:.3f}s", stats.elapsedSeconds);
+    std::println("Throughput: {:.1f} requests/s", stats.throughput);
+    std::println("Assignment latency p50: {:.0f}us, p99: {:.0f}us, max: {:.0f}us",
+                 stats.p50LatencyMicros, stats.p99LatencyMicros, stats.maxLatencyMicros);
+}
+
+void Service::submit(ServiceMessage message) {
+    message.receivedAt = ServiceClock::now();
+    {
+        const std::lock_guard<std::mutex> guard(_mutex);
+        _messages.push_back(std::move(message));
+    }
+
+    _messageAvailable.notify_one();
+}
+
+void Service::run(std::ostream &out) {
+    _startedAt = ServiceClock::now();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        const auto hasMessage = [this]() { return !_messages.empty(); };
+        if (_pending.empty()) {
+            _messageAvailable.wait(lock, hasMessage);
+        } else if (!_messageAvailable.wait_until(lock, _batchDeadline, hasMessage)) {
+            // Batching window of the oldest pending request expired
+            lock.unlock();
+            solveBatch(out);
+            lock.lock();
+            continue;
+        }
+
+        const ServiceMessage message = std::move(_messages.front());
+        _messages.pop_front();
+
+        lock.unlock();
+        const bool keepRunning = handleMessage(message, out);
+        lock.lock();
+
+        if (!keepRunning) {
+            break;
+        }
+    }
+
+    _stoppedAt = ServiceClock::now();
+}
+
+ServiceStats Service::getStats() const {
+    DoubleVector latencies = _latencies;
+    const auto percentile = [&latencies](double fraction) {
+        if (latencies.empty()) {
+            return 0.0;
+        }
+
+        const auto index =
+            static_cast<size_t>(fraction * static_cast<double>(latencies.size() - 1));
+        std::nth_element(latencies.begin(), latencies.begin() + static_cast<std::ptrdiff_t>(index),
+                         latencies.end());
+        return latencies[index];
+    };
+
+    const double elapsedSeconds = std::chrono::duration<double>(_stoppedAt - _startedAt).count();
+    const double p50 = percentile(0.5);
+    const double p99 = percentile(0.99);
+    const double max = latencies.empty() ? 0.0 : *std::ranges::max_element(latencies);
+
+    return {.requestsReceived = _requestsReceived,
+            .requestsAssigned = _latencies.size(),
+            .batchesSolved = _batchesSolved,
+            .elapsedSeconds = elapsedSeconds,
+            .throughput = elapsedSeconds > 0.0
+                              ? static_cast<double>(_latencies.size()) / elapsedSeconds
+                              : 0.0,
+            .p50LatencyMicros = p50,
+            .p99LatencyMicros = p99,
+            .maxLatencyMicros = max};
+}
+
+bool Service::handleMessage(const ServiceMessage &message, std::ostream &out) {
+    if (message.type == "request") {
+        queueRequest(message);
+        if (_serviceSettings.maxBatchSize > 0 && _pending.size() >= _serviceSettings.maxBatchSize) {
+            solveBatch(out);
+        }
+
+        return true;
+    }
+
+    if (message.type == "advance") {
+        solveBatch(out);
+        advance(message.minutes);
+        return true;
+    }
+
+    if (message.type == "flush") {
+        solveBatch(out);
+        return true;
+    }
+
+    if (message.type == "shutdown") {
+        solveBatch(out);
+        return false;
+    }
+
+    std::println(stderr, "Error: Unknown message type: {}", message.type);
+    return true;
+}
+
+void Service::queueRequest(const ServiceMessage &message) {
+    ++_requestsReceived;
+
+    const auto &smallestRoundTrips = _env.getSmallestRoundTrips();
+    if (message.dropoff >= _env.getNumberOfDropoffs() || message.duration == 0 ||
+        message.arrival > _simSettings.maxTimeTillArrival ||
+        message.duration < smallestRoundTrips[message.dropoff]) {
+        _rejected.push_back(message.id);
+        return;
+    }
+
+    if (_pending.empty()) {
+        _batchDeadline =
+            message.receivedAt + std::chrono::milliseconds(_serviceSettings.batchWindow);
+    }
+
+    auto &request = _pending.emplace_back(message.dropoff, message.duration, message.arrival);
+    request.setId(message.id);
+    _receivedAt.try_emplace(message.id, message.receivedAt);
+}
+
+void Service::solveBatch(std::ostream &out) {
+    Requests requests = std::move(_pending);
+    _pending.clear();
+
+    requests.insert(requests.end(), _unassigned.begin(), _unassigned.end());
+    requests.insert(requests.end(), _early.begin(), _early.end());
+    _unassigned.clear();
+    _early.clear();
+
+    if (requests.empty() && _expired.empty() && _rejected.empty()) {
+        return;
+    }
+
+    ServiceResponse response;
+    response.batch = _batchesSolved;
+    response.timestep = _timestep;
+    if (!requests.empty()) {
+        const auto solveStart = ServiceClock::now();
+        auto batchResult =
+            Scheduler::scheduleBatch(_env, requests, _simSettings, {.arena = &_arena});
+        const auto solveEnd = ServiceClock::now();
+
+        response.solveMicros = static_cast<Uint64>(
+            std::chrono::duration_cast<std::chrono::microseconds>(solveEnd - solveStart).count());
+
+        response.assignments.reserve(batchResult.simulations.size());
+        for (const auto &simulation : batchResult.simulations) {
+            const auto id = simulation.getRequestId();
+            response.assignments.push_back({.id = id,
+                                            .parking = simulation.getParkingNode(),
+                                            .routeDuration = simulation.getRouteDuration()});
+
+            const auto receivedAt = _receivedAt.find(id);
+            if (receivedAt != _receivedAt.end()) {
+                _latencies.push_back(
+                    std::chrono::duration<double, std::micro>(solveEnd - receivedAt->second)
+                        .count());
+                _receivedAt.erase(receivedAt);
+            }
+        }
+
+        for (const auto &request : batchResult.earlyRequests) {
+            response.deferred.push_back(request.getId());
+        }
+
+        for (const auto &request : batchResult.unassignedRequests) {
+            response.unassigned.push_back(request.getId());
+        }
+
+        _simulations.splice(_simulations.end(), batchResult.simulations);
+        _unassigned = std::move(batchResult.unassignedRequests);
+        _early = std::move(batchResult.earlyRequests);
+        ++_batchesSolved;
+        _arena.reset();
+    }
+
+    response.expired = std::move(_expired);
+    response.rejected = std::move(_rejected);
+    _expired.clear();
+    _rejected.clear();
+
+    writeLine(response, out);
+}
+
+void Service::advance(Uint minutes) {
+    for (Uint minute = 0; minute < minutes; ++minute) {
+        ++_timestep;
+        Simulator::updateSimulations(_simulations, _env);
+
+        std::erase_if(_unassigned, [this](Request &request) {
+            request.decrementDuration();
+            if (!request.isDead()) {
+                return false;
+            }
+
+            _expired.push_back(request.getId());
+            _receivedAt.erase(request.getId());
+            return true;
+        });
+
+        Simulator::decrementArrivalTime(_early);
+    }
+}
@@ -0,0 +1,210 @@
+#include "shard.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "aggregated_result.hpp"
+#include "utils.hpp"
+
+using namespace palloc;
+
+static Uint parseShardNumber(std::string_view str, std::string_view shardStr) {
+    Uint value{};
+    const auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (str.empty() || error != std::errc{} || end != str.data() + str.size()) {
+        throw std::invalid_argument("Expected shard as i/N: " + std::string(shardStr));
+    }
+
+    return value;
+}
+
+static void writeLine(const auto &value, std::ostream &out) {
+    std::string buffer;
+    const auto error = glz::write_json(value, buffer);
+    if (error) {
+        throw std::runtime_error("Failed to serialize shard line");
+    }
+
+    out << buffer << '\n';
+}
+
+static void readLine(auto &value, std::istream &in, const Path &shardPath) {
+    std::string line;
+    if (!std::getline(in, line)) {
+        throw std::runtime_error("Shard file ended early: " + shardPath.string());
+    }
+
+    const auto error = glz::read_json(value, line);
+    if (error) {
+        const auto errorStr = glz::format_error(error, line);
+        throw std::runtime_error("Failed to read shard file: " + shardPath.string() +
+                                 "\nwith error: " + errorStr);
+    }
+}
+
+std::pair<Uint, Uint> Shard::parse(std::string_view shardStr) {
+    const auto separator = shardStr.find('/');
+    if (separator == std::string_view::npos) {
+        throw std::invalid_argument("Expected shard as i/N: " + std::string(shardStr));
+    }
+
+    const auto shard = parseShardNumber(shardStr.substr(0, separator), shardStr);
+    const auto shardCount = parseShardNumber(shardStr.substr(separator + 1), shardStr);
+    if (shard >= shardCount) {
+        throw std::invalid_argument("Shard index must be below the shard count: " +
+                                    std::string(shardStr));
+    }
+
+    return {shard, shardCount};
+}
+
+std::vector<Uint> Shard::getJobs(Uint numberOfJobs, Uint shard, Uint shardCount) {
+    const Uint step = std::max<Uint>(shardCount, 1);
+
+    std::vector<Uint> jobs;
+    jobs.reserve(numberOfJobs / step + 1);
+    for (Uint job = shard % step; job < numberOfJobs; job += step) {
+        jobs.push_back(job);
+    }
+
+    return jobs;
+}
+
+void Shard::save(const Path &shardPath, const ShardHeader &header,
+                 const std::vector<ShardJob> &jobs, Uint timeElapsed) {
+    std::ofstream out(shardPath);
+    if (!out) {
+        throw std::runtime_error("Failed to open shard file: " + shardPath.string());
+    }
+
+    writeLine(header, out);
+    for (const auto &job : jobs) {
+        writeLine(job, out);
+    }
+
+    writeLine(ShardFooter{.timeElapsed = timeElapsed}, out);
+    if (!out) {
+        throw std::runtime_error("Failed to write shard file: " + shardPath.string());
+    }
+}
+
+void Shard::merge(const std::vector<Path> &shardPaths, const Path &outputPath) {
+    if (shardPaths.empty()) {
+        throw std::invalid_argument("Expected shard files to merge");
+    }
+
+    // Every shard stays open and is read one job at a time, indexed by its shard number
+    const auto shardCount = static_cast<Uint>(shardPaths.size());
+    std::vector<std::ifstream> inputs(shardCount);
+    std::vector<Path> inputPaths(shardCount);
+    std::optional<ShardHeader> sweep;
+    for (const auto &shardPath : shardPaths) {
+        std::ifstream in(shardPath);
+        if (!in) {
+            throw std::runtime_error("Shard file does not exist: " + shardPath.string());
+        }
+
+        ShardHeader header;
+        readLine(header, in, shardPath);
+        if (!sweep) {
+            sweep = header;
+        }
+
+        if (header.shardCount != shardCount || header.shard >= shardCount) {
+            throw std::runtime_error("Expected all " + std::to_string(header.shardCount) +
+                                     " shards of the sweep but got " +
+                                     std::to_string(shardCount));
+        }
+
+        if (header.numberOfRuns != sweep->numberOfRuns || header.branching != sweep->branching ||
+            header.branchSettings != sweep->branchSettings || header.branchSettings.empty()) {
+            throw std::runtime_error("Shard belongs to a different sweep: " +
+                                     shardPath.string());
+        }
+
+        if (inputs[header.shard].is_open()) {
+            throw std::runtime_error("Shard given more than once: " + shardPath.string());
+        }
+
+        inputs[header.shard] = std::move(in);
+        inputPaths[header.shard] = shardPath;
+    }
+
+    const auto numberOfBranches = static_cast<Uint>(sweep->branchSettings.size());
+    std::vector<std::ofstream> outputs;
+    outputs.reserve(numberOfBranches);
+    for (Uint branch = 0; branch < numberOfBranches; ++branch) {
+        const auto branchPath =
+            sweep->branching ? utils::getBranchPath(outputPath, branch) : outputPath;
+        auto &out = outputs.emplace_back(branchPath);
+        if (!out) {
+            throw std::runtime_error("Failed to open output file: " + branchPath.string());
+        }
+
+        out << R"({"traces":[)";
+    }
+
+    // Jobs are read in the order a single process aggregates them, so the totals match exactly
+    std::vector<RunTotals> totals(numberOfBranches);
+    std::string buffer;
+    const Uint numberOfJobs = sweep->numberOfRuns * numberOfBranches;
+    for (Uint job = 0; job < numberOfJobs; ++job) {
+        const auto shard = job % shardCount;
+        ShardJob shardJob;
+        readLine(shardJob, inputs[shard], inputPaths[shard]);
+        if (shardJob.job != job) {
+            throw std::runtime_error("Expected job " + std::to_string(job) +
+                                     " in shard file: " + inputPaths[shard].string());
+        }
+
+        const Uint run = job / numberOfBranches;
+        const Uint branch = job % numberOfBranches;
+
+        buffer.clear();
+        const auto error = glz::write_json(shardJob.result.getTraceList(), buffer);
+        if (error) {
+            throw std::runtime_error("Failed to serialize traces of job " + std::to_string(job));
+        }
+
+        auto &out = outputs[branch];
+        if (run > 0) {
+            out << ',';
+        }
+
+        out << buffer;
+        totals[branch].add(shardJob.result);
+    }
+
+    Uint timeElapsed = 0;
+    for (Uint shard = 0; shard < shardCount; ++shard) {
+        ShardFooter footer;
+        readLine(footer, inputs[shard], inputPaths[shard]);
+        timeElapsed = std::max(timeElapsed, footer.timeElapsed);
+    }
+
+    // The totals replace the empty trace list their serialization starts with
+    constexpr std::string_view emptyTraces = R"({"traces":[])";
+    for (Uint branch = 0; branch < numberOfBranches; ++branch) {
+        AggregatedResult result(totals[branch], TraceLists{});
+        result.setTimeElapsed(timeElapsed);
+
+        buffer.clear();
+        const auto error = glz::write_json(result, buffer);
+        if (error) {
+            throw std::runtime_error("Failed to serialize merged result");
+        }
+
+        assert(std::string_view(buffer).starts_with(emptyTraces));
+        auto &out = outputs[branch];
+        out << ']' << std::string_view(buffer).substr(emptyTraces.size());
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Failed to write merged result: " + outputPath.string());
+        }
+    }
+}
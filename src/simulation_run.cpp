@@ -0,0 +1,89 @@
+#include "simulation_run.hpp"
+
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "utils.hpp"
+
+using namespace palloc;
+
+SimulationRun::SimulationRun(Environment env, const SimulatorSettings &simSettings,
+                             Uint runNumber)
+    : _env(std::move(env)),
+      _simSettings(simSettings),
+      // A single run without recording, so nothing is written while it is stepped
+      _source(RequestSourceFactory::create(simSettings, {.numberOfRunsToAggregate = 1},
+                                           _env.getNumberOfDropoffs(), runNumber)),
+      _resources(_env, _simSettings) {
+    if (simSettings.timesteps == 0) {
+        throw std::invalid_argument("A run needs at least one timestep");
+    }
+
+    _state.runNumber = runNumber;
+    _state.simSettings = simSettings;
+    if (simSettings.useTimeExpanded) {
+        _state.timeline = OccupancyTimeline(_env.getNumberOfParkings());
+    }
+}
+
+const RunSnapshot &SimulationRun::step() {
+    if (isFinished()) {
+        throw std::runtime_error("Run already simulated all " +
+                                 std::to_string(_simSettings.timesteps) + " timesteps");
+    }
+
+    const auto batch = Simulator::stepRun(_state, _env, *_source, _simSettings, _resources);
+    _totalCost += batch.totalCost;
+
+    // New simulations are spliced onto the end and nothing is removed until the next step
+    const auto &simulations = _state.simulations;
+    const auto firstStarted =
+        std::prev(simulations.end(), static_cast<std::ptrdiff_t>(batch.scheduled));
+
+    // The unassigned requests only belong to this timestep when its batch left them behind,
+    // otherwise they were dropped by an earlier batch and are waiting to be retried
+    const bool solvedBatch = batch.timestep == _state.timestep;
+    std::span<const Request> droppedRequests;
+    if (solvedBatch) {
+        droppedRequests = _state.unassignedRequests;
+    }
+
+    _snapshot.emplace(RunSnapshot{
+        .timestep = _state.timestep,
+        .timeOfDay = utils::getTimeOfDay(_simSettings.startTime, _state.timestep),
+        .availableParkingSpots = _env.getAvailableParkingSpots(),
+        .simulations = simulations,
+        .startedSimulations = std::ranges::subrange(firstStarted, simulations.end()),
+        .droppedRequests = droppedRequests,
+        .batch = batch,
+        .pendingRequests = _state.requests.size(),
+        .earlyRequests = _state.earlyRequests.size(),
+        .metrics = getMetrics()});
+    return *_snapshot;
+}
+
+std::generator<const RunSnapshot &> SimulationRun::steps() {
+    while (!isFinished()) {
+        co_yield step();
+    }
+}
+
+bool SimulationRun::isFinished() const noexcept {
+    return _state.timestep >= _simSettings.timesteps;
+}
+
+Uint SimulationRun::getTimestep() const noexcept { return _state.timestep; }
+
+RunMetrics SimulationRun::getMetrics() const noexcept {
+    return {.requestsGenerated = _source->getRequestsGenerated(),
+            .requestsScheduled = _state.requestsScheduled,
+            .processedRequests = _state.totalProcessedRequests,
+            .droppedRequests = _state.droppedRequests,
+            .totalCost = _totalCost,
+            .totalDuration = _state.runDurationSum,
+            .batches = _state.batches,
+            .fastPathBatches = _state.fastPathBatches};
+}
+
+const Environment &SimulationRun::getEnvironment() const noexcept { return _env; }
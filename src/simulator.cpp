@@ -1,15 +1,27 @@
 #include "simulator.hpp"
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <exception>
 #include <iostream>
+#include <memory>
 #include <numeric>
+#include <optional>
 #include <print>
 #include <thread>
 
 #include "aggregated_result.hpp"
+#include "checkpoint.hpp"
+#include "demand_forecast.hpp"
+#include "report.hpp"
+#include "run_sink.hpp"
 #include "scheduler.hpp"
+#include "scratch_arena.hpp"
+#include "shard.hpp"
+#include "simulation_run.hpp"
+#include "spsc_queue.hpp"
 #include "utils.hpp"
 
 using namespace palloc;
@@ -22,8 +34,12 @@ Uint Simulation::getRequestDuration() const noexcept { return _requestDuration;
 
 Uint Simulation::getDurationLeft() const noexcept { return _durationLeft; }
 
+Uint Simulation::getEarlyTimeLeft() const noexcept { return _earlyTimeLeft; }
+
 Uint Simulation::getRouteDuration() const noexcept { return _routeDuration; }
 
+Uint Simulation::getRequestId() const noexcept { return _requestId; }
+
 bool Simulation::isInDropoff() const noexcept { return _inDropoff; }
 
 bool Simulation::hasVisitedParking() const noexcept { return _visitedParking; }
@@ -38,18 +54,15 @@ void Simulation::setHasVisitedParking(bool visitedParking) noexcept {
     _visitedParking = visitedParking;
 }
 
+bool Simulation::hasPendingClaim() const noexcept { return _pendingClaim; }
+
+void Simulation::setHasPendingClaim(bool pendingClaim) noexcept { _pendingClaim = pendingClaim; }
+
 void Simulation::decrementDuration() noexcept { --_durationLeft; }
 
 void Simulation::decrementEarlyArrival() noexcept { --_earlyTimeLeft; }
 
-void Simulator::simulate(Environment &env, const SimulatorSettings &simSettings,
-                         const OutputSettings &outputSettings,
-                         const GeneralSettings &generalSettings) {
-    assert(simSettings.timesteps > 0);
-    assert(simSettings.requestRate > 0);
-    assert(simSettings.startTime <= 1439);
-    assert(outputSettings.numberOfRunsToAggregate > 0);
-
+static void printSetup(Environment &env, const SimulatorSettings &simSettings) {
     const auto numberOfDropoffs = env.getNumberOfDropoffs();
     const auto numberOfParkings = env.getNumberOfParkings();
     std::println("Dropoff nodes: {}", numberOfDropoffs);
@@ -60,74 +73,317 @@ void Simulator::simulate(Environment &env, const SimulatorSettings &simSettings,
                  std::reduce(availableParkingSpots.begin(), availableParkingSpots.end()));
 
     std::println("Using {} generator with seed: {}", simSettings.randomGenerator, simSettings.seed);
+    if (simSettings.batchSize > 0) {
+        std::println("Solving batches of {} requests, waiting at most {} minutes",
+                     simSettings.batchSize, simSettings.batchInterval);
+    }
 
     Uint startHour = simSettings.startTime / 60;
     Uint startMin = simSettings.startTime % 60;
     std::println("Starting simulation from start time: {} ({:02d}:{:02d})", simSettings.startTime,
                  startHour, startMin);
+}
 
-    Uint timesteps = simSettings.timesteps;
-    Uint numberOfRuns = outputSettings.numberOfRunsToAggregate;
+static void printSummary(const AggregatedResult &result) {
+    std::println("Total requests generated: {}", result.getTotalRequestsGenerated());
+    std::println("Total requests scheduled: {}", result.getTotalRequestsScheduled());
+    std::println("Total requests unassigned: {}",
+                 result.getTotalRequestsGenerated() - result.getTotalRequestsScheduled());
+    std::println("Total requests dropped: {}", result.getTotalDroppedRequests());
 
-    Uint numberOfThreads = generalSettings.numberOfThreads;
-    if (numberOfRuns > 1) {
-        std::println("Simulating {} timesteps aggregating {} runs using {} threads...", timesteps,
-                     numberOfRuns, numberOfThreads);
-    } else {
-        std::println("Simulating {} timesteps...", timesteps);
+    const double avgDuration = result.getAvgDuration();
+    const auto minutes = static_cast<Uint>(avgDuration);
+    const auto seconds = static_cast<Uint>((avgDuration - minutes) * 60);
+    std::println("Average roundtrip time: {}m {}s", minutes, seconds);
+
+    std::println("Average objective cost: {}", result.getAvgCost());
+
+    std::println("Average variable count: {}", result.getAvgVariableCount());
+
+    std::println("Batches solved without solver: {} of {}", result.getTotalFastPathBatches(),
+                 result.getTotalBatches());
+}
+
+static double toMegabytes(Uint64 bytes) noexcept {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+/**
+ * Largest peak of any run and allocations of all runs per category, and resident memory per phase
+ */
+static void printMemory(const MemoryReport &memory) {
+    constexpr std::array categories{
+        std::pair{"Traces", &RunMemory::traces},
+        std::pair{"Assignments", &RunMemory::assignments},
+        std::pair{"Simulations", &RunMemory::simulations},
+        std::pair{"Requests", &RunMemory::requests},
+        std::pair{"Environment", &RunMemory::environment},
+    };
+
+    Uint64 peakBytes = 0;
+    for (const auto &run : memory.runs) {
+        peakBytes = std::max(peakBytes, run.peakBytes);
+    }
+
+    std::println("Peak memory of a run: {:.2f} MB", toMegabytes(peakBytes));
+    for (const auto &[name, category] : categories) {
+        Uint64 categoryPeak = 0;
+        Uint64 allocations = 0;
+        for (const auto &run : memory.runs) {
+            categoryPeak = std::max(categoryPeak, (run.*category).peakBytes);
+            allocations += (run.*category).allocations;
+        }
+
+        std::println("  {}: {:.2f} MB peak, {} allocations", name, toMegabytes(categoryPeak),
+                     allocations);
+    }
+
+    for (const auto &phase : memory.phases) {
+        std::println("Resident memory after {}: {:.2f} MB, peak {:.2f} MB", phase.phase,
+                     toMegabytes(phase.residentBytes), toMegabytes(phase.peakResidentBytes));
     }
+}
+
+using ResultSlots = std::vector<std::optional<Result>>;
 
+static Results collectResults(ResultSlots &resultSlots) {
     Results results;
-    results.reserve(numberOfRuns);
-    std::mutex resultsMutex;
-    std::atomic<Uint> atomicRunCounter{0};
+    results.reserve(resultSlots.size());
+    for (auto &slot : resultSlots) {
+        assert(slot.has_value());
+        results.push_back(std::move(*slot));
+    }
+
+    return results;
+}
+
+/**
+ * Write the finished jobs of a shard in job order, job run * branches + branch
+ */
+static void saveShard(std::vector<ResultSlots> &branchSlots,
+                      const std::vector<SimulatorSettings> &branchSettings, bool branching,
+                      const OutputSettings &outputSettings, Uint timeElapsed) {
+    const auto numberOfBranches = static_cast<Uint>(branchSlots.size());
+    const ShardHeader header{.shard = outputSettings.shardIndex,
+                             .shardCount = outputSettings.shardCount,
+                             .numberOfRuns = outputSettings.numberOfRunsToAggregate,
+                             .branching = branching,
+                             .branchSettings = branchSettings};
+
+    std::vector<ShardJob> jobs;
+    for (Uint run = 0; run < header.numberOfRuns; ++run) {
+        for (Uint branch = 0; branch < numberOfBranches; ++branch) {
+            auto &slot = branchSlots[branch][run];
+            if (slot) {
+                jobs.push_back(
+                    {.job = run * numberOfBranches + branch, .result = std::move(*slot)});
+            }
+        }
+    }
+
+    Shard::save(outputSettings.outputPath, header, jobs, timeElapsed);
+    std::println("Wrote {} jobs of shard {}/{} to {}", jobs.size(), header.shard,
+                 header.shardCount, outputSettings.outputPath.string());
+}
+
+/**
+ * Run numberOfJobs jobs on numberOfThreads threads, each thread taking the next job when done
+ */
+static void runJobs(Uint numberOfJobs, Uint numberOfThreads, const auto &job) {
+    std::atomic<Uint> atomicJobCounter{0};
     auto worker = [&]() {
-        for (Uint run = atomicRunCounter.fetch_add(1); run < numberOfRuns;
-             run = atomicRunCounter.fetch_add(1)) {
-            Simulator::simulateRun(env, simSettings, outputSettings, results, resultsMutex, run);
+        for (Uint jobIndex = atomicJobCounter.fetch_add(1); jobIndex < numberOfJobs;
+             jobIndex = atomicJobCounter.fetch_add(1)) {
+            job(jobIndex);
         }
     };
 
     std::vector<std::thread> threads;
-    threads.reserve(numberOfRuns);
-    const auto startClock = std::chrono::high_resolution_clock::now();
-    for (Uint run = 0; run < numberOfThreads; ++run) {
+    threads.reserve(numberOfThreads);
+    for (Uint thread = 0; thread < numberOfThreads; ++thread) {
         threads.emplace_back(worker);
     }
 
     for (auto &thread : threads) {
         thread.join();
     }
+}
+
+void Simulator::simulate(Environment &env, const SimulatorSettings &simSettings,
+                         const OutputSettings &outputSettings,
+                         const GeneralSettings &generalSettings) {
+    assert(simSettings.timesteps > 0);
+    assert(simSettings.requestRate > 0);
+    assert(simSettings.startTime <= 1439);
+    assert(outputSettings.numberOfRunsToAggregate > 0);
+
+    printSetup(env, simSettings);
+
+    Uint timesteps = simSettings.timesteps;
+    Uint numberOfRuns = outputSettings.numberOfRunsToAggregate;
+
+    Uint numberOfThreads = generalSettings.numberOfThreads;
+    if (numberOfRuns > 1) {
+        std::println("Simulating {} timesteps aggregating {} runs using {} threads...", timesteps,
+                     numberOfRuns, numberOfThreads);
+    } else {
+        std::println("Simulating {} timesteps...", timesteps);
+    }
+
+    // Every run owns its slot so results end up in run order whatever the number of threads
+    ResultSlots resultSlots(numberOfRuns);
+    const auto runs =
+        Shard::getJobs(numberOfRuns, outputSettings.shardIndex, outputSettings.shardCount);
+
+    std::vector<PhaseMemory> phases;
+    if (outputSettings.accountMemory) {
+        phases.push_back(MemoryAccount::samplePhase("setup"));
+    }
+
+    const auto startClock = std::chrono::high_resolution_clock::now();
+    runJobs(static_cast<Uint>(runs.size()), numberOfThreads, [&](Uint job) {
+        const Uint run = runs[job];
+        resultSlots[run].emplace(Simulator::simulateRun(env, simSettings, outputSettings, run,
+                                                        generalSettings.pipelined));
+    });
 
     const auto endClock = std::chrono::high_resolution_clock::now();
+    if (outputSettings.accountMemory) {
+        phases.push_back(MemoryAccount::samplePhase("runs"));
+    }
+
     const auto timeElapsed = static_cast<Uint>(
         std::chrono::duration_cast<std::chrono::milliseconds>(endClock - startClock).count());
 
     std::println("Finished after {}ms", timeElapsed);
 
-    AggregatedResult result(results);
-    result.setTimeElapsed(timeElapsed);
-
-    std::println("Total requests generated: {}", result.getTotalRequestsGenerated());
-    std::println("Total requests scheduled: {}", result.getTotalRequestsScheduled());
-    std::println("Total requests unassigned: {}",
-                 result.getTotalRequestsGenerated() - result.getTotalRequestsScheduled());
-    std::println("Total requests dropped: {}", result.getTotalDroppedRequests());
+    if (outputSettings.shardCount > 1) {
+        std::vector<ResultSlots> branchSlots{std::move(resultSlots)};
+        saveShard(branchSlots, {simSettings}, false, outputSettings, timeElapsed);
+        return;
+    }
 
-    const double avgDuration = result.getAvgDuration();
-    const auto minutes = static_cast<Uint>(avgDuration);
-    const auto seconds = static_cast<Uint>((avgDuration - minutes) * 60);
-    std::println("Average roundtrip time: {}m {}s", minutes, seconds);
+    AggregatedResult result(collectResults(resultSlots));
+    result.setTimeElapsed(timeElapsed);
 
-    std::println("Average objective cost: {}", result.getAvgCost());
+    if (outputSettings.accountMemory) {
+        phases.push_back(MemoryAccount::samplePhase("aggregation"));
+        for (auto &phase : phases) {
+            result.addMemoryPhase(std::move(phase));
+        }
+    }
 
-    std::println("Average variable count: {}", result.getAvgVariableCount());
+    printSummary(result);
+    if (result.getMemory()) {
+        printMemory(*result.getMemory());
+    }
 
     if (!outputSettings.outputPath.empty()) {
         result.saveToFile(outputSettings.outputPath, outputSettings.prettify);
     }
 }
 
+void Simulator::simulateBranches(Environment &env, const SimulatorSettings &simSettings,
+                                 const std::vector<SimulatorSettings> &branchSettings,
+                                 const OutputSettings &outputSettings,
+                                 const GeneralSettings &generalSettings) {
+    assert(!branchSettings.empty());
+    assert(simSettings.warmupTimesteps < simSettings.timesteps);
+    assert(outputSettings.checkpointPath.empty() && outputSettings.recordPath.empty());
+
+    printSetup(env, simSettings);
+
+    const Uint numberOfRuns = outputSettings.numberOfRunsToAggregate;
+    const auto numberOfBranches = static_cast<Uint>(branchSettings.size());
+    const Uint numberOfThreads = generalSettings.numberOfThreads;
+    std::println(
+        "Simulating {} warm-up timesteps forked into {} branches of {} timesteps aggregating {} "
+        "runs using {} threads...",
+        simSettings.warmupTimesteps, numberOfBranches, simSettings.timesteps, numberOfRuns,
+        numberOfThreads);
+
+    const auto numberOfDropoffs = env.getNumberOfDropoffs();
+    const auto startClock = std::chrono::high_resolution_clock::now();
+
+    // A shard only warms up the runs it has branches of
+    const auto jobs = Shard::getJobs(numberOfRuns * numberOfBranches, outputSettings.shardIndex,
+                                     outputSettings.shardCount);
+    std::vector<Uint> runs;
+    for (const auto job : jobs) {
+        if (runs.empty() || runs.back() != job / numberOfBranches) {
+            runs.push_back(job / numberOfBranches);
+        }
+    }
+
+    // The warm-up of every run is simulated once and stays read-only while branches fork from it
+    std::vector<std::shared_ptr<const RunState>> prefixes(numberOfRuns);
+    runJobs(static_cast<Uint>(runs.size()), numberOfThreads, [&](Uint runIndex) {
+        const Uint run = runs[runIndex];
+        Environment runEnv = env;
+        const auto source =
+            RequestSourceFactory::create(simSettings, outputSettings, numberOfDropoffs, run);
+
+        RunState prefix;
+        prefix.runNumber = run;
+        prefix.simSettings = simSettings;
+        advanceRun(prefix, runEnv, *source, simSettings, outputSettings,
+                   simSettings.warmupTimesteps, Path{});
+        prefixes[run] = std::make_shared<const RunState>(std::move(prefix));
+    });
+
+    std::vector<ResultSlots> branchSlots(numberOfBranches, ResultSlots(numberOfRuns));
+    runJobs(static_cast<Uint>(jobs.size()), numberOfThreads, [&](Uint jobIndex) {
+        const Uint job = jobs[jobIndex];
+        const Uint run = job / numberOfBranches;
+        const Uint branch = job % numberOfBranches;
+        const auto &branchSimSettings = branchSettings[branch];
+        const RunState &prefix = *prefixes[run];
+
+        Environment runEnv = env;
+        runEnv.getAvailableParkingSpots() = prefix.availableParkingSpots;
+
+        const auto source =
+            RequestSourceFactory::create(branchSimSettings, outputSettings, numberOfDropoffs, run);
+        source->setState(prefix.sourceState);
+
+        RunState state = forkRun(prefix, branchSimSettings);
+        advanceRun(state, runEnv, *source, branchSimSettings, outputSettings,
+                   branchSimSettings.timesteps, Path{});
+
+        branchSlots[branch][run].emplace(createResult(state, *source, &prefix));
+    });
+
+    const auto endClock = std::chrono::high_resolution_clock::now();
+    const auto timeElapsed = static_cast<Uint>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(endClock - startClock).count());
+
+    std::println("Finished after {}ms", timeElapsed);
+
+    if (outputSettings.shardCount > 1) {
+        saveShard(branchSlots, branchSettings, true, outputSettings, timeElapsed);
+        return;
+    }
+
+    for (Uint branch = 0; branch < numberOfBranches; ++branch) {
+        const auto &branchSimSettings = branchSettings[branch];
+        std::println(
+            "\nBranch {}: batch interval {}, commit interval {}, minimum parking time {}, weighted "
+            "parking {}",
+            branch, branchSimSettings.batchInterval, branchSimSettings.commitInterval,
+            branchSimSettings.minParkingTime, branchSimSettings.useWeightedParking);
+
+        AggregatedResult result(collectResults(branchSlots[branch]));
+        result.setTimeElapsed(timeElapsed);
+
+        printSummary(result);
+
+        if (!outputSettings.outputPath.empty()) {
+            result.saveToFile(utils::getBranchPath(outputSettings.outputPath, branch),
+                              outputSettings.prettify);
+        }
+    }
+}
+
 static Assignments createAssignments(const Simulations &newSimulations, const Environment &env) {
     Assignments assignments;
     assignments.reserve(newSimulations.size());
@@ -141,162 +397,298 @@ static Assignments createAssignments(const Simulations &newSimulations, const En
     return assignments;
 }
 
-void Simulator::simulateRun(Environment env, const SimulatorSettings &simSettings,
-                            const OutputSettings &outputSettings, Results &results,
-                            std::mutex &resultsMutex, Uint runNumber) {
-    const auto &availableParkingSpots = env.getAvailableParkingSpots();
+static void addToTimeline(const Simulations &newSimulations, const Environment &env,
+                          Uint timestep, OccupancyTimeline &timeline) {
+    for (const auto &simulation : newSimulations) {
+        const auto parkingNode = simulation.getParkingNode();
+        const auto tillArrival = simulation.getEarlyTimeLeft();
+        if (simulation.hasPendingClaim()) {
+            timeline.addClaim(parkingNode, timestep + tillArrival);
+        }
+
+        const auto timeToDrive = env.getParkingToDropoff(parkingNode, simulation.getDropoffNode());
+        const auto release = OccupancyTimeline::getReleaseTimestep(
+            timestep, tillArrival, simulation.getRequestDuration(), timeToDrive);
+        timeline.addRelease(parkingNode, release);
+    }
+}
+
+/**
+ * Stages of a run which do not depend on solving. Requests of upcoming timesteps are generated
+ * ahead on one thread and traces are completed with their assignments on another, while the
+ * calling thread only solves batches.
+ */
+class RunPipeline {
+   public:
+    explicit RunPipeline(RequestSource &source, const Environment &env, Uint startTime,
+                         Uint firstTimestep, Uint lastTimestep, TraceList &traces)
+        : _requests(QUEUE_CAPACITY), _pendingTraces(QUEUE_CAPACITY) {
+        // Both stages allocate on behalf of the run which owns the pipeline
+        auto *account = MemoryAccount::getCurrent();
+        _producer = std::jthread([this, &source, startTime, firstTimestep, lastTimestep,
+                                  account]() {
+            MemoryScope scope(account);
+            try {
+                for (Uint timestep = firstTimestep; timestep <= lastTimestep; ++timestep) {
+                    const Uint timeOfDay = utils::getTimeOfDay(startTime, timestep);
+                    if (!_requests.push(source.generate(timeOfDay))) {
+                        return;
+                    }
+                }
+            } catch (...) {
+                _producerError = std::current_exception();
+                _requests.close();
+            }
+        });
+
+        _consumer = std::jthread([this, &env, &traces, account]() {
+            MemoryScope scope(account);
+            try {
+                while (auto pending = _pendingTraces.pop()) {
+                    auto &[newSimulations, trace] = *pending;
+                    trace.setAssignments(createAssignments(newSimulations, env));
+                    traces.push_back(std::move(trace));
+                }
+            } catch (...) {
+                _consumerError = std::current_exception();
+                _pendingTraces.close();
+            }
+        });
+    }
+
+    RunPipeline(const RunPipeline &) = delete;
+    RunPipeline &operator=(const RunPipeline &) = delete;
+
+    ~RunPipeline() {
+        _requests.close();
+        _pendingTraces.close();
+    }
+
+    /**
+     * Take the requests of the next timestep
+     */
+    Requests takeRequests() {
+        auto requests = _requests.pop();
+        if (!requests) {
+            std::rethrow_exception(_producerError);
+        }
+
+        return std::move(*requests);
+    }
+
+    /**
+     * Complete a trace with the assignments of the simulations started in its timestep
+     */
+    void addTrace(Simulations newSimulations, Trace trace) {
+        if (!_pendingTraces.push({std::move(newSimulations), std::move(trace)})) {
+            std::rethrow_exception(_consumerError);
+        }
+    }
+
+    /**
+     * Wait until every trace is complete
+     */
+    void finish() {
+        _pendingTraces.close();
+        _consumer.join();
+        _producer.join();
+        if (_consumerError) {
+            std::rethrow_exception(_consumerError);
+        }
+    }
+
+   private:
+    static constexpr size_t QUEUE_CAPACITY = 64;
+
+    SpscQueue<Requests> _requests;
+    SpscQueue<std::pair<Simulations, Trace>> _pendingTraces;
+    std::exception_ptr _producerError;
+    std::exception_ptr _consumerError;
+
+    // Joined before the queues are destroyed
+    std::jthread _producer;
+    std::jthread _consumer;
+};
+
+Result Simulator::simulateRun(Environment env, const SimulatorSettings &simSettings,
+                              const OutputSettings &outputSettings, Uint runNumber,
+                              bool pipelined) {
+    // Every run has its own account, so the peaks of runs on other threads do not mix
+    std::unique_ptr<MemoryAccount> account;
+    if (outputSettings.accountMemory) {
+        account = std::make_unique<MemoryAccount>();
+        account->allocate(MemoryCategory::ENVIRONMENT, env.getCopiedBytes());
+    }
+
+    const MemoryScope scope(account.get());
+
     const auto numberOfDropoffs = env.getNumberOfDropoffs();
 
-    RequestGenerator generator({.randomGenerator = simSettings.randomGenerator,
-                                .dropoffNodes = numberOfDropoffs,
-                                .maxTimeTillArrival = simSettings.maxTimeTillArrival,
-                                .maxRequestDuration = simSettings.maxRequestDuration,
-                                .seed = simSettings.seed + runNumber,
-                                .requestRate = simSettings.requestRate});
+    const bool checkpointing = !outputSettings.checkpointPath.empty();
+    const Path checkpointPath =
+        checkpointing ? utils::getRunPath(outputSettings.checkpointPath, runNumber,
+                                          outputSettings.numberOfRunsToAggregate)
+                      : Path{};
+    const bool resume =
+        checkpointing && outputSettings.resume && std::filesystem::exists(checkpointPath);
+
+    const auto source = RequestSourceFactory::create(simSettings, outputSettings,
+                                                     numberOfDropoffs, runNumber, resume);
 
     const Uint timesteps = simSettings.timesteps;
 
-    Requests requests;
-    requests.reserve(static_cast<size_t>(timesteps) *
-                     static_cast<size_t>(std::ceil(simSettings.requestRate)));
+    RunState state;
+    if (resume) {
+        state = Checkpoint::load(checkpointPath, simSettings, runNumber);
+        source->setState(state.sourceState);
+        env.getAvailableParkingSpots() = state.availableParkingSpots;
+    } else {
+        state.runNumber = runNumber;
+        state.simSettings = simSettings;
+        // Requests only wait until they expire, so reserve for the request rate over that window
+        // instead of the whole run
+        const Uint requestWindow = simSettings.maxTimeTillArrival + simSettings.batchInterval +
+                                   simSettings.maxRequestDuration;
+        state.requests.reserve(static_cast<size_t>(requestWindow) *
+                               static_cast<size_t>(std::ceil(simSettings.requestRate)));
+        state.runCostVec.reserve(timesteps);
+    }
 
-    Requests unassignedRequests;
-    Requests earlyRequests;
+    advanceRun(state, env, *source, simSettings, outputSettings, timesteps, checkpointPath,
+               pipelined);
 
-    Simulations simulations;
+    auto result = createResult(state, *source);
+    if (account) {
+        result.setMemory(account->getRunMemory());
+    }
 
-    DoubleVector runCostVec;
-    runCostVec.reserve(timesteps);
+    return result;
+}
 
-    TraceList traces;
-    size_t droppedRequests = 0;
-    Uint runDurationSum = 0;
-    size_t requestsScheduled = 0;
-    size_t totalProcessedRequests = 0;
-    size_t runTotalVariableCount = 0;
-    for (Uint timestep = 1; timestep <= timesteps; ++timestep) {
-        Uint currentTimeOfDay = ((simSettings.startTime + timestep - 1) % 1440);
-        updateSimulations(simulations, env);
-        removeDeadRequests(unassignedRequests);
-        decrementArrivalTime(earlyRequests);
-        insertNewRequests(generator, currentTimeOfDay, requests);
-        cutImpossibleRequests(requests, env.getSmallestRoundTrips());
-
-        double totalBatchCost = 0.0;
-        Uint totalBatchDuration = 0;
-        size_t processedRequests = 0;
-        size_t batchScheduled = 0;
-        size_t totalVariableCount = 0;
-        Assignments assignments;
-
-        bool isBatchingStep = timestep % simSettings.batchInterval == 0 || timestep == timesteps;
-        if (isBatchingStep) {
-            requests.insert(requests.end(), unassignedRequests.begin(), unassignedRequests.end());
-            requests.insert(requests.end(), earlyRequests.begin(), earlyRequests.end());
-
-            unassignedRequests.clear();
-            earlyRequests.clear();
-
-            if (!requests.empty()) {
-                const auto batchResult = Scheduler::scheduleBatch(env, requests, simSettings);
-                requests.clear();
-
-                totalBatchCost = batchResult.totalCost;
-                processedRequests = batchResult.processedRequests;
-                totalProcessedRequests += processedRequests;
-                totalBatchDuration = batchResult.totalDuration;
-
-                unassignedRequests = batchResult.unassignedRequests;
-                droppedRequests += unassignedRequests.size();
-
-                earlyRequests = batchResult.earlyRequests;
-
-                const auto &newSimulations = batchResult.simulations;
-                assignments = createAssignments(newSimulations, env);
-
-                simulations.insert(simulations.end(), newSimulations.begin(), newSimulations.end());
-                batchScheduled += newSimulations.size();
-                requestsScheduled += batchScheduled;
-
-                totalVariableCount = batchResult.variableCount;
-            }
-        }
+/**
+ * Completes a trace every timestep with the batch solved in it and the assignments of the
+ * simulations it started, on the consumer thread of the pipeline when there is one
+ */
+class TraceSink {
+   public:
+    explicit TraceSink(TraceList &traces, const Environment &env, RunPipeline *pipeline)
+        : _traces(traces), _env(env), _pipeline(pipeline) {}
 
-        const auto totalAvailableParkingSpots =
-            std::reduce(availableParkingSpots.begin(), availableParkingSpots.end());
-
-        if (outputSettings.outputTrace) {
-            double batchAverageDuration =
-                batchScheduled == 0
-                    ? 0.0
-                    : static_cast<double>(totalBatchDuration) / static_cast<double>(batchScheduled);
-            double batchAverageCost = processedRequests == 0
-                                          ? 0.0
-                                          : totalBatchCost / static_cast<double>(processedRequests);
-
-            Uint batchStepsCompleted = timestep / simSettings.batchInterval;
-            if (timestep == timesteps && timestep % simSettings.batchInterval != 0) {
-                ++batchStepsCompleted;
-            }
+    void batchSolved(const BatchEvent &event) { _batch = event; }
 
-            traces.emplace_back(assignments, requests.size(), simulations.size(),
-                                totalAvailableParkingSpots, droppedRequests, earlyRequests.size(),
-                                timestep, currentTimeOfDay, batchAverageCost, batchAverageDuration,
-                                totalVariableCount);
+    void simulationStarted(Uint, const Simulation &simulation) {
+        _newSimulations.push_back(simulation);
+    }
+
+    void arrivedAtParking(Uint, const Simulation &) noexcept {}
+    void departed(Uint, const Simulation &) noexcept {}
+    void requestDropped(Uint, const Request &) noexcept {}
+
+    void timestepEnded(const TimestepEvent &event) {
+        const auto totalAvailableParkingSpots =
+            std::reduce(event.availableParkingSpots.begin(), event.availableParkingSpots.end());
+
+        Trace trace(Assignments{}, event.pendingRequests, event.ongoingSimulations,
+                    totalAvailableParkingSpots, event.droppedRequests, event.earlyRequests,
+                    event.timestep, event.timeOfDay, _batch.getAverageCost(),
+                    _batch.getAverageDuration(), _batch.variableCount, _batch.usedFastPath,
+                    _batch.batchSize, _batch.latency);
+        if (_pipeline != nullptr) {
+            _pipeline->addTrace(std::move(_newSimulations), std::move(trace));
+        } else {
+            trace.setAssignments(createAssignments(_newSimulations, _env));
+            _traces.push_back(std::move(trace));
         }
 
-        runCostVec.push_back(totalBatchCost);
-        runDurationSum += totalBatchDuration;
-        runTotalVariableCount += totalVariableCount;
+        _newSimulations.clear();
+        _batch = {};
     }
 
-    assert(requests.empty());
+   private:
+    TraceList &_traces;
+    const Environment &_env;
+    RunPipeline *_pipeline;
 
-    const Uint requestsGenerated = generator.getRequestsGenerated();
+    BatchEvent _batch{};
+    Simulations _newSimulations;
+};
 
-    const size_t requestsUnassigned = requestsGenerated - requestsScheduled;
+/**
+ * Measures the run for the report aggregated across runs
+ */
+class ReportSink {
+   public:
+    explicit ReportSink(RunReport &report) : _report(report) {}
 
-    const std::lock_guard<std::mutex> guard(resultsMutex);
+    void batchSolved(const BatchEvent &event) noexcept { _batch = event; }
 
-    double runCostSum = utils::KahanSum(runCostVec);
-    results.emplace_back(traces, simSettings, droppedRequests, runDurationSum, runCostSum,
-                         runTotalVariableCount, requestsGenerated, requestsScheduled,
-                         requestsUnassigned, totalProcessedRequests);
-}
+    void simulationStarted(Uint, const Simulation &simulation) {
+        _report.addRouteDuration(simulation.getRouteDuration());
+    }
 
-void Simulator::updateSimulations(Simulations &simulations, Environment &env) {
-    const auto &dropoffToParking = env.getDropoffToParking();
-    const auto &parkingToDropoff = env.getParkingToDropoff();
+    void arrivedAtParking(Uint, const Simulation &) noexcept {}
+    void departed(Uint, const Simulation &) noexcept {}
+    void requestDropped(Uint, const Request &) noexcept {}
+
+    void timestepEnded(const TimestepEvent &event) {
+        _report.addTimestep(event.availableParkingSpots, event.droppedRequests,
+                            _batch.getAverageCost(), _batch.getAverageDuration());
+        _batch = {};
+    }
+
+   private:
+    RunReport &_report;
+    BatchEvent _batch{};
+};
+
+/**
+ * Advance the simulations by a timestep, telling the sink about arrivals and departures
+ */
+template <RunSink Sink>
+static void advanceSimulations(Simulations &simulations, Environment &env, Uint timestep,
+                               Sink &sink) {
+    const auto &travelTimes = *env.getTravelTimes();
     auto &availableParkingSpots = env.getAvailableParkingSpots();
-    const auto simulate = [&dropoffToParking, &parkingToDropoff,
-                           &availableParkingSpots](auto &simulation) {
+    const auto simulate = [&travelTimes, &availableParkingSpots, timestep,
+                           &sink](auto &simulation) {
         if (simulation.isEarly()) {
             simulation.decrementEarlyArrival();
+            if (!simulation.isEarly() && simulation.hasPendingClaim()) {
+                // The spot was kept free for this arrival by the occupancy timeline
+                const auto parkingNode = simulation.getParkingNode();
+                assert(availableParkingSpots[parkingNode] > 0);
+                --availableParkingSpots[parkingNode];
+                simulation.setHasPendingClaim(false);
+            }
+
             return false;
         }
 
         const auto dropoffNode = simulation.getDropoffNode();
         const auto parkingNode = simulation.getParkingNode();
         if (simulation.isInDropoff() && !simulation.hasVisitedParking()) {
-            const auto timeToParking = dropoffToParking[dropoffNode][parkingNode];
+            const auto timeToParking = travelTimes.getDropoffToParking(dropoffNode, parkingNode);
             const auto durationPassed =
                 simulation.getRequestDuration() - simulation.getDurationLeft();
             if (durationPassed == timeToParking) {
                 simulation.setIsInDropoff(false);
                 simulation.setHasVisitedParking(true);
+                sink.arrivedAtParking(timestep, simulation);
             }
         }
 
-        const auto timeToDrive = parkingToDropoff[parkingNode][dropoffNode];
+        const auto timeToDrive = travelTimes.getParkingToDropoff(parkingNode, dropoffNode);
         if (!simulation.isInDropoff() && simulation.getDurationLeft() == timeToDrive) {
             simulation.setIsInDropoff(true);
             ++availableParkingSpots[parkingNode];
+            sink.departed(timestep, simulation);
         }
 
         simulation.decrementDuration();
         if (simulation.isDead() && !simulation.isInDropoff() && timeToDrive == 0) {
             simulation.setIsInDropoff(true);
             ++availableParkingSpots[parkingNode];
+            sink.departed(timestep, simulation);
         }
 
         assert(!simulation.isDead() || (simulation.isDead() && simulation.isInDropoff()));
@@ -307,9 +699,347 @@ void Simulator::updateSimulations(Simulations &simulations, Environment &env) {
     std::erase_if(simulations, simulate);
 }
 
-void Simulator::insertNewRequests(RequestGenerator &generator, Uint currentTimeOfDay,
+RunResources::RunResources(const Environment &env, const SimulatorSettings &simSettings) {
+    if (simSettings.horizon > 0) {
+        forecast.emplace(env, simSettings);
+    }
+}
+
+/**
+ * Simulate the timestep after state.timestep, instantiated once per sink
+ */
+template <RunSink Sink>
+static void stepTimestep(RunState &state, Environment &env, RequestSource &source,
+                         const SimulatorSettings &simSettings, RunResources &resources,
+                         RunPipeline *pipeline, Sink &sink) {
+    auto &availableParkingSpots = env.getAvailableParkingSpots();
+    auto &arena = resources.arena;
+    auto &forecast = resources.forecast;
+
+    auto &timeline = state.timeline;
+    auto &requests = state.requests;
+    auto &unassignedRequests = state.unassignedRequests;
+    auto &earlyRequests = state.earlyRequests;
+    auto &simulations = state.simulations;
+    auto &runCostVec = state.runCostVec;
+    auto &droppedRequests = state.droppedRequests;
+    auto &runDurationSum = state.runDurationSum;
+    auto &requestsScheduled = state.requestsScheduled;
+    auto &totalProcessedRequests = state.totalProcessedRequests;
+    auto &runTotalVariableCount = state.runTotalVariableCount;
+
+    const Uint timestep = state.timestep + 1;
+    Uint currentTimeOfDay = utils::getTimeOfDay(simSettings.startTime, timestep);
+    advanceSimulations(simulations, env, timestep, sink);
+    if (simSettings.useTimeExpanded) {
+        timeline.advance(timestep);
+    }
+
+    Simulator::removeDeadRequests(unassignedRequests);
+    Simulator::decrementArrivalTime(earlyRequests);
+    if (pipeline != nullptr) {
+        const auto newRequests = pipeline->takeRequests();
+        requests.insert(requests.end(), newRequests.begin(), newRequests.end());
+    } else {
+        Simulator::insertNewRequests(source, currentTimeOfDay, requests);
+    }
+
+    Simulator::cutImpossibleRequests(requests, env.getSmallestRoundTrips());
+    if (requests.empty()) {
+        state.pendingSince = 0;
+    } else if (state.pendingSince == 0) {
+        state.pendingSince = timestep;
+    }
+
+    double totalBatchCost = 0.0;
+    Uint totalBatchDuration = 0;
+    size_t totalVariableCount = 0;
+
+    if (Simulator::isBatchingStep(state, simSettings, env.getSmallestRoundTrips(), timestep)) {
+        const Uint latency = state.pendingSince == 0 ? 0 : timestep - state.pendingSince;
+        BatchEvent batch{.timestep = timestep, .latency = latency};
+        state.pendingSince = 0;
+
+        requests.insert(requests.end(), unassignedRequests.begin(), unassignedRequests.end());
+        requests.insert(requests.end(), earlyRequests.begin(), earlyRequests.end());
+
+        unassignedRequests.clear();
+        earlyRequests.clear();
+
+        batch.batchSize = requests.size();
+        if (!requests.empty()) {
+            SchedulerContext context{.arena = &arena};
+            if (simSettings.useTimeExpanded) {
+                context.timeline = &timeline;
+            }
+
+            if (forecast) {
+                context.reservedSpots = forecast->getReservations(currentTimeOfDay, simulations);
+            }
+
+            auto batchResult = Scheduler::scheduleBatch(env, requests, simSettings, context);
+            requests.clear();
+
+            totalBatchCost = batchResult.totalCost;
+            totalProcessedRequests += batchResult.processedRequests;
+            totalBatchDuration = batchResult.totalDuration;
+
+            unassignedRequests = std::move(batchResult.unassignedRequests);
+            droppedRequests += unassignedRequests.size();
+            for (const auto &request : unassignedRequests) {
+                sink.requestDropped(timestep, request);
+            }
+
+            earlyRequests = std::move(batchResult.earlyRequests);
+
+            auto &newSimulations = batchResult.simulations;
+            if (simSettings.useTimeExpanded) {
+                addToTimeline(newSimulations, env, timestep, timeline);
+            }
+
+            for (const auto &simulation : newSimulations) {
+                sink.simulationStarted(timestep, simulation);
+            }
+
+            requestsScheduled += newSimulations.size();
+            totalVariableCount = batchResult.variableCount;
+
+            batch.processedRequests = batchResult.processedRequests;
+            batch.scheduled = newSimulations.size();
+            batch.totalCost = totalBatchCost;
+            batch.totalDuration = totalBatchDuration;
+            batch.variableCount = totalVariableCount;
+            batch.usedFastPath = batchResult.usedFastPath;
+
+            simulations.splice(simulations.end(), newSimulations);
+            ++state.batches;
+            state.fastPathBatches += batch.usedFastPath ? 1 : 0;
+            arena.reset();
+        }
+
+        sink.batchSolved(batch);
+    }
+
+    sink.timestepEnded({.timestep = timestep,
+                        .timeOfDay = currentTimeOfDay,
+                        .pendingRequests = requests.size(),
+                        .ongoingSimulations = simulations.size(),
+                        .availableParkingSpots = availableParkingSpots,
+                        .droppedRequests = droppedRequests,
+                        .earlyRequests = earlyRequests.size()});
+
+    runCostVec.push_back(totalBatchCost);
+    runDurationSum += totalBatchDuration;
+    runTotalVariableCount += totalVariableCount;
+
+    state.timestep = timestep;
+}
+
+/**
+ * Timestep loop of a run, instantiated once per sink
+ */
+template <RunSink Sink>
+static void runTimesteps(RunState &state, Environment &env, RequestSource &source,
+                         const SimulatorSettings &simSettings,
+                         const OutputSettings &outputSettings, Uint lastTimestep,
+                         const Path &checkpointPath, RunPipeline *pipeline, Sink &sink) {
+    const bool checkpointing = !checkpointPath.empty();
+    const Uint timesteps = simSettings.timesteps;
+
+    RunResources resources(env, simSettings);
+    while (state.timestep < lastTimestep) {
+        stepTimestep(state, env, source, simSettings, resources, pipeline, sink);
+
+        // The last timestep forces a batch which a longer run would not solve, so the final
+        // checkpoint is taken before it and a resumed run may be finished or extended alike
+        const Uint timestep = state.timestep;
+        const bool lastCheckpoint = timestep + 1 == timesteps;
+        if (checkpointing && timestep < timesteps &&
+            (timestep % outputSettings.checkpointInterval == 0 || lastCheckpoint)) {
+            // Everything up to the recorded offset has to be on disk before the checkpoint
+            source.flush();
+            state.sourceState = source.getState();
+            state.availableParkingSpots = env.getAvailableParkingSpots();
+            Checkpoint::save(state, checkpointPath);
+        }
+    }
+}
+
+void Simulator::advanceRun(RunState &state, Environment &env, RequestSource &source,
+                           const SimulatorSettings &simSettings,
+                           const OutputSettings &outputSettings, Uint lastTimestep,
+                           const Path &checkpointPath, bool pipelined) {
+    assert(lastTimestep <= simSettings.timesteps);
+
+    auto &availableParkingSpots = env.getAvailableParkingSpots();
+    if (simSettings.useTimeExpanded && state.timestep == 0) {
+        state.timeline = OccupancyTimeline(env.getNumberOfParkings());
+    }
+
+    // Every spot is free before the first timestep, so the free spots are the capacities
+    if (outputSettings.outputReport && state.timestep == 0) {
+        state.report.emplace(availableParkingSpots);
+    }
+
+    // Checkpoints need the source and traces in step with the solved timesteps
+    std::optional<RunPipeline> pipeline;
+    if (pipelined && checkpointPath.empty()) {
+        pipeline.emplace(source, env, simSettings.startTime, state.timestep + 1, lastTimestep,
+                         state.traces);
+    }
+
+    RunPipeline *pipelinePtr = pipeline ? &*pipeline : nullptr;
+    const auto run = [&](auto &&sink) {
+        runTimesteps(state, env, source, simSettings, outputSettings, lastTimestep,
+                     checkpointPath, pipelinePtr, sink);
+    };
+
+    // Runs without traces or a report do not pay for observing their events
+    if (outputSettings.outputTrace && state.report) {
+        run(SinkChain(TraceSink(state.traces, env, pipelinePtr), ReportSink(*state.report)));
+    } else if (outputSettings.outputTrace) {
+        run(TraceSink(state.traces, env, pipelinePtr));
+    } else if (state.report) {
+        run(ReportSink(*state.report));
+    } else {
+        run(NullSink{});
+    }
+
+    if (pipeline) {
+        pipeline->finish();
+    }
+
+    state.sourceState = source.getState();
+    state.availableParkingSpots = availableParkingSpots;
+}
+
+/**
+ * Keeps the batch of the timestep for the caller of a single step
+ */
+class BatchSink {
+   public:
+    explicit BatchSink(BatchEvent &batch) : _batch(batch) {}
+
+    void batchSolved(const BatchEvent &event) noexcept { _batch = event; }
+    void simulationStarted(Uint, const Simulation &) noexcept {}
+    void arrivedAtParking(Uint, const Simulation &) noexcept {}
+    void departed(Uint, const Simulation &) noexcept {}
+    void requestDropped(Uint, const Request &) noexcept {}
+    void timestepEnded(const TimestepEvent &) noexcept {}
+
+   private:
+    BatchEvent &_batch;
+};
+
+BatchEvent Simulator::stepRun(RunState &state, Environment &env, RequestSource &source,
+                              const SimulatorSettings &simSettings, RunResources &resources) {
+    BatchEvent batch{};
+    BatchSink sink(batch);
+    stepTimestep(state, env, source, simSettings, resources, nullptr, sink);
+    return batch;
+}
+
+RunState Simulator::forkRun(const RunState &prefix, const SimulatorSettings &simSettings) {
+    RunState state;
+    state.runNumber = prefix.runNumber;
+    state.timestep = prefix.timestep;
+    state.simSettings = simSettings;
+    state.sourceState = prefix.sourceState;
+    state.requests = prefix.requests;
+    state.unassignedRequests = prefix.unassignedRequests;
+    state.earlyRequests = prefix.earlyRequests;
+    state.simulations = prefix.simulations;
+    state.availableParkingSpots = prefix.availableParkingSpots;
+    state.timeline = prefix.timeline;
+    state.droppedRequests = prefix.droppedRequests;
+    state.runDurationSum = prefix.runDurationSum;
+    state.requestsScheduled = prefix.requestsScheduled;
+    state.totalProcessedRequests = prefix.totalProcessedRequests;
+    state.runTotalVariableCount = prefix.runTotalVariableCount;
+    state.batches = prefix.batches;
+    state.fastPathBatches = prefix.fastPathBatches;
+    state.pendingSince = prefix.pendingSince;
+    state.report = prefix.report;
+    state.runCostVec.reserve(simSettings.timesteps - prefix.timestep);
+    return state;
+}
+
+Result Simulator::createResult(RunState &state, const RequestSource &source,
+                               const RunState *prefix) {
+    assert(state.requests.empty());
+
+    TraceList traces;
+    DoubleVector runCostVec;
+    if (prefix != nullptr) {
+        traces = prefix->traces;
+        traces.splice(traces.end(), state.traces);
+
+        runCostVec.reserve(prefix->runCostVec.size() + state.runCostVec.size());
+        runCostVec.insert(runCostVec.end(), prefix->runCostVec.begin(), prefix->runCostVec.end());
+        runCostVec.insert(runCostVec.end(), state.runCostVec.begin(), state.runCostVec.end());
+    } else {
+        traces = std::move(state.traces);
+        runCostVec = std::move(state.runCostVec);
+    }
+
+    const Uint requestsGenerated = source.getRequestsGenerated();
+
+    const size_t requestsUnassigned = requestsGenerated - state.requestsScheduled;
+
+    double runCostSum = utils::KahanSum(runCostVec);
+    return Result(std::move(traces), state.simSettings, state.droppedRequests,
+                  state.runDurationSum, runCostSum, state.runTotalVariableCount,
+                  requestsGenerated, state.requestsScheduled, requestsUnassigned,
+                  state.totalProcessedRequests, state.batches, state.fastPathBatches,
+                  std::move(state.report));
+}
+
+void Simulator::updateSimulations(Simulations &simulations, Environment &env) {
+    NullSink sink;
+    advanceSimulations(simulations, env, 0, sink);
+}
+
+bool Simulator::isBatchingStep(const RunState &state, const SimulatorSettings &simSettings,
+                               const UintVector &smallestRoundTrips, Uint timestep) {
+    if (timestep == simSettings.timesteps) {
+        return true;
+    }
+
+    if (simSettings.batchSize == 0) {
+        return timestep % simSettings.batchInterval == 0;
+    }
+
+    // Dropped requests are left to their own deadline, retrying them every time a saturated
+    // city has enough of them would drop the same requests again every minute
+    if (state.requests.size() >= simSettings.batchSize) {
+        return true;
+    }
+
+    if (state.pendingSince != 0 && timestep - state.pendingSince >= simSettings.batchInterval) {
+        return true;
+    }
+
+    const bool entersCommitWindow =
+        std::ranges::any_of(state.earlyRequests, [&simSettings](const Request &request) {
+            return request.getArrival() == simSettings.commitInterval;
+        });
+    if (entersCommitWindow) {
+        return true;
+    }
+
+    // Dropped requests lose a minute per timestep and become unservable once shorter than their
+    // shortest stay, so solve in their last minute
+    return std::ranges::any_of(
+        state.unassignedRequests, [&simSettings, &smallestRoundTrips](const Request &request) {
+            const auto shortestStay =
+                smallestRoundTrips[request.getDropoffNode()] + simSettings.minParkingTime;
+            return request.getRequestDuration() == shortestStay;
+        });
+}
+
+void Simulator::insertNewRequests(RequestSource &source, Uint currentTimeOfDay,
                                   Requests &requests) {
-    const auto newRequests = generator.generate(currentTimeOfDay);
+    const auto newRequests = source.generate(currentTimeOfDay);
     requests.insert(requests.end(), newRequests.begin(), newRequests.end());
 }
 
@@ -0,0 +1,92 @@
+#include "spatial_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace palloc;
+
+SpatialIndex::SpatialIndex(const std::vector<Point> &points) : _points(points) {
+    if (_points.empty()) {
+        return;
+    }
+
+    const auto [minX, maxX] = std::ranges::minmax(_points, {}, &Point::x);
+    const auto [minY, maxY] = std::ranges::minmax(_points, {}, &Point::y);
+    _minX = minX.x;
+    _minY = minY.y;
+
+    const auto cellsPerSide = static_cast<size_t>(
+        std::max(1.0, std::ceil(std::sqrt(static_cast<double>(_points.size()) / POINTS_PER_CELL))));
+    _columns = cellsPerSide;
+    _rows = cellsPerSide;
+
+    // Degenerate extents still need a positive cell size
+    _cellWidth = std::max((maxX.x - _minX) / static_cast<double>(_columns), 1.0);
+    _cellHeight = std::max((maxY.y - _minY) / static_cast<double>(_rows), 1.0);
+
+    // Counting sort of the points by cell keeps points of a cell in ascending order
+    UintVector pointCells(_points.size());
+    _cellStart.assign(_columns * _rows + 1, 0);
+    for (size_t i = 0; i < _points.size(); ++i) {
+        const auto column = getCell(_points[i].x, _minX, _cellWidth, _columns);
+        const auto row = getCell(_points[i].y, _minY, _cellHeight, _rows);
+        pointCells[i] = static_cast<Uint>(row * _columns + column);
+        ++_cellStart[pointCells[i] + 1];
+    }
+
+    for (size_t cell = 1; cell < _cellStart.size(); ++cell) {
+        _cellStart[cell] += _cellStart[cell - 1];
+    }
+
+    UintVector nextSlot(_cellStart.begin(), _cellStart.end() - 1);
+    _cellPoints.resize(_points.size());
+    for (size_t i = 0; i < _points.size(); ++i) {
+        _cellPoints[nextSlot[pointCells[i]]++] = static_cast<Uint>(i);
+    }
+}
+
+void SpatialIndex::query(const Point &center, double radius, Indices &result) const {
+    result.clear();
+    if (_points.empty() || radius < 0.0) {
+        return;
+    }
+
+    const auto firstColumn = getCell(center.x - radius, _minX, _cellWidth, _columns);
+    const auto lastColumn = getCell(center.x + radius, _minX, _cellWidth, _columns);
+    const auto firstRow = getCell(center.y - radius, _minY, _cellHeight, _rows);
+    const auto lastRow = getCell(center.y + radius, _minY, _cellHeight, _rows);
+
+    const double radiusSquared = radius * radius;
+    for (size_t row = firstRow; row <= lastRow; ++row) {
+        for (size_t column = firstColumn; column <= lastColumn; ++column) {
+            const auto cell = row * _columns + column;
+            for (Uint k = _cellStart[cell]; k < _cellStart[cell + 1]; ++k) {
+                const auto pointIndex = _cellPoints[k];
+                const double dx = _points[pointIndex].x - center.x;
+                const double dy = _points[pointIndex].y - center.y;
+                if (dx * dx + dy * dy <= radiusSquared) {
+                    result.push_back(pointIndex);
+                }
+            }
+        }
+    }
+
+    std::ranges::sort(result);
+}
+
+size_t SpatialIndex::size() const noexcept { return _points.size(); }
+
+size_t SpatialIndex::getOwnedBytes() const noexcept {
+    return _points.capacity() * sizeof(Point) +
+           (_cellStart.capacity() + _cellPoints.capacity()) * sizeof(Uint);
+}
+
+size_t SpatialIndex::getCell(double position, double min, double cellSize,
+                             size_t cells) const noexcept {
+    const double cell = std::floor((position - min) / cellSize);
+    if (cell <= 0.0) {
+        return 0;
+    }
+
+    return std::min(static_cast<size_t>(cell), cells - 1);
+}
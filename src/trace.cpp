@@ -14,8 +14,18 @@ Uint Trace::getAvailableParkingSpots() const noexcept { return _availableParking
 
 Uint Trace::getTimeStep() const noexcept { return _timestep; }
 
+bool Trace::hasUsedFastPath() const noexcept { return _usedFastPath; }
+
+size_t Trace::getBatchSize() const noexcept { return _batchSize; }
+
+Uint Trace::getBatchLatency() const noexcept { return _batchLatency; }
+
 double Trace::getAverageCost() const noexcept { return _averageCost; }
 
 double Trace::getAverageDuration() const noexcept { return _averageDuration; }
 
 Assignments Trace::getAssignments() const noexcept { return _assignments; }
+
+void Trace::setAssignments(Assignments assignments) noexcept {
+    _assignments = std::move(assignments);
+}
@@ -0,0 +1,214 @@
+#include "travel_times.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+using namespace palloc;
+
+std::optional<size_t> TravelTimes::Row::find(Uint parkingNode) const noexcept {
+    // Dense rows hold every parking at its own index
+    if (parkingNode < parkings.size() && parkings[parkingNode] == parkingNode) {
+        return parkingNode;
+    }
+
+    const auto it = std::ranges::lower_bound(parkings, parkingNode);
+    if (it == parkings.end() || *it != parkingNode) {
+        return std::nullopt;
+    }
+
+    return static_cast<size_t>(it - parkings.begin());
+}
+
+Uint TravelTimes::Row::getRoundTrip(size_t entry) const noexcept {
+    return static_cast<Uint>(toParking[entry]) + toDropoff[entry];
+}
+
+TravelTimes::Row TravelTimes::getRow(Uint dropoffNode) const noexcept {
+    const auto begin = _rowStart[dropoffNode];
+    const auto size = _rowStart[dropoffNode + 1] - begin;
+    return {.parkings = std::span(_parkings).subspan(begin, size),
+            .toParking = std::span(_toParking).subspan(begin, size),
+            .toDropoff = std::span(_toDropoff).subspan(begin, size),
+            .offset = begin};
+}
+
+Uint TravelTimes::getDropoffToParking(Uint dropoffNode, Uint parkingNode) const noexcept {
+    return _toParking[getEntry(dropoffNode, parkingNode)];
+}
+
+Uint TravelTimes::getParkingToDropoff(Uint parkingNode, Uint dropoffNode) const noexcept {
+    return _toDropoff[getEntry(dropoffNode, parkingNode)];
+}
+
+Uint TravelTimes::getRoundTrip(Uint dropoffNode, Uint parkingNode) const noexcept {
+    const auto entry = getEntry(dropoffNode, parkingNode);
+    return static_cast<Uint>(_toParking[entry]) + _toDropoff[entry];
+}
+
+UintVector TravelTimes::getSmallestRoundTrips() const {
+    UintVector smallestRoundTrips(_numberOfDropoffs, UNREACHABLE);
+    for (Uint i = 0; i < _numberOfDropoffs; ++i) {
+        const auto row = getRow(i);
+        for (size_t k = 0; k < row.parkings.size(); ++k) {
+            smallestRoundTrips[i] = std::min(smallestRoundTrips[i], row.getRoundTrip(k));
+        }
+    }
+
+    return smallestRoundTrips;
+}
+
+size_t TravelTimes::getNumberOfDropoffs() const noexcept { return _numberOfDropoffs; }
+
+size_t TravelTimes::getNumberOfParkings() const noexcept { return _numberOfParkings; }
+
+size_t TravelTimes::getNumberOfEntries() const noexcept { return _parkings.size(); }
+
+size_t TravelTimes::getEntry(Uint dropoffNode, Uint parkingNode) const noexcept {
+    const auto row = getRow(dropoffNode);
+    const auto entry = row.find(parkingNode);
+    assert(entry.has_value());
+    return row.offset + *entry;
+}
+
+TravelTimesBuilder::TravelTimesBuilder(const StorageSettings &storageSettings)
+    : _storageSettings(storageSettings) {}
+
+void TravelTimesBuilder::addDropoffRow(std::span<const Uint> durations) {
+    const auto dropoffNode = _rows.size();
+    if (_dropoffRowsEnded) {
+        throw std::invalid_argument("Unexpected dropoff row " + std::to_string(dropoffNode));
+    }
+
+    if (!_numberOfParkings) {
+        _numberOfParkings = durations.size();
+    } else if (durations.size() != *_numberOfParkings) {
+        throw std::invalid_argument("Dropoff row " + std::to_string(dropoffNode) + " has " +
+                                    std::to_string(durations.size()) + " durations, expected " +
+                                    std::to_string(*_numberOfParkings));
+    }
+
+    auto &row = _rows.emplace_back();
+    for (Uint j = 0; j < durations.size(); ++j) {
+        if (isKept(durations[j])) {
+            row.push_back({.parkingNode = j,
+                           .toParking = static_cast<TravelTimes::Duration>(durations[j]),
+                           .toDropoff = MISSING});
+        }
+    }
+
+    // Keeping the nearest parkings by the drive there is all a single row can decide
+    const auto nearest = _storageSettings.nearestParkings;
+    if (nearest > 0 && row.size() > nearest) {
+        const auto byDuration = [](const Entry &a, const Entry &b) {
+            return std::tie(a.toParking, a.parkingNode) < std::tie(b.toParking, b.parkingNode);
+        };
+        std::ranges::nth_element(row, row.begin() + nearest, byDuration);
+        row.resize(nearest);
+        std::ranges::sort(row, {}, &Entry::parkingNode);
+    }
+
+    row.shrink_to_fit();
+}
+
+void TravelTimesBuilder::endDropoffRows() {
+    if (_dropoffRowsEnded) {
+        return;
+    }
+
+    _dropoffRowsEnded = true;
+    const auto pendingRows = std::move(_pendingParkingRows);
+    for (size_t j = 0; j < pendingRows.size(); ++j) {
+        applyParkingRow(static_cast<Uint>(j), pendingRows[j]);
+    }
+}
+
+void TravelTimesBuilder::addParkingRow(std::span<const Uint> durations) {
+    const auto parkingNode = static_cast<Uint>(_parkingRowsAdded++);
+    if (!_dropoffRowsEnded) {
+        _pendingParkingRows.emplace_back(durations.begin(), durations.end());
+        return;
+    }
+
+    applyParkingRow(parkingNode, durations);
+}
+
+TravelTimes TravelTimesBuilder::build() {
+    endDropoffRows();
+
+    const auto numberOfParkings = _numberOfParkings.value_or(_parkingRowsAdded);
+    if (_parkingRowsAdded != numberOfParkings) {
+        throw std::invalid_argument("Travel times have " + std::to_string(_parkingRowsAdded) +
+                                    " parking rows, expected " +
+                                    std::to_string(numberOfParkings));
+    }
+
+    const auto cutoff = _storageSettings.travelTimeCutoff;
+    const auto isStored = [cutoff](const Entry &entry) {
+        const Uint roundTrip = static_cast<Uint>(entry.toParking) + entry.toDropoff;
+        return entry.toDropoff != MISSING && (cutoff == 0 || roundTrip <= cutoff);
+    };
+
+    size_t numberOfEntries = 0;
+    for (const auto &row : _rows) {
+        numberOfEntries += static_cast<size_t>(std::ranges::count_if(row, isStored));
+    }
+
+    TravelTimes travelTimes;
+    travelTimes._numberOfDropoffs = _rows.size();
+    travelTimes._numberOfParkings = numberOfParkings;
+    travelTimes._rowStart.reserve(_rows.size() + 1);
+    travelTimes._rowStart.push_back(0);
+    travelTimes._parkings.reserve(numberOfEntries);
+    travelTimes._toParking.reserve(numberOfEntries);
+    travelTimes._toDropoff.reserve(numberOfEntries);
+    for (auto &row : _rows) {
+        for (const auto &entry : row) {
+            if (isStored(entry)) {
+                travelTimes._parkings.push_back(entry.parkingNode);
+                travelTimes._toParking.push_back(entry.toParking);
+                travelTimes._toDropoff.push_back(entry.toDropoff);
+            }
+        }
+
+        travelTimes._rowStart.push_back(travelTimes._parkings.size());
+        row = {};
+    }
+
+    _rows.clear();
+    return travelTimes;
+}
+
+size_t TravelTimesBuilder::getNumberOfDropoffRows() const noexcept { return _rows.size(); }
+
+size_t TravelTimesBuilder::getNumberOfParkingRows() const noexcept { return _parkingRowsAdded; }
+
+void TravelTimesBuilder::applyParkingRow(Uint parkingNode, std::span<const Uint> durations) {
+    if ((_numberOfParkings && parkingNode >= *_numberOfParkings) ||
+        durations.size() != _rows.size()) {
+        throw std::invalid_argument("Parking row " + std::to_string(parkingNode) + " has " +
+                                    std::to_string(durations.size()) + " durations, expected " +
+                                    std::to_string(_rows.size()));
+    }
+
+    for (size_t i = 0; i < durations.size(); ++i) {
+        auto &row = _rows[i];
+        const auto guess = std::min<size_t>(parkingNode, row.size());
+        auto it = row.begin() + static_cast<std::ptrdiff_t>(guess);
+        if (it == row.end() || it->parkingNode != parkingNode) {
+            it = std::ranges::lower_bound(row, parkingNode, {}, &Entry::parkingNode);
+        }
+
+        if (it != row.end() && it->parkingNode == parkingNode && isKept(durations[i])) {
+            it->toDropoff = static_cast<TravelTimes::Duration>(durations[i]);
+        }
+    }
+}
+
+bool TravelTimesBuilder::isKept(Uint duration) const noexcept {
+    // Either leg alone exceeding the cutoff rules out the round trip
+    const auto cutoff = _storageSettings.travelTimeCutoff;
+    return duration < MISSING && (cutoff == 0 || duration <= cutoff);
+}
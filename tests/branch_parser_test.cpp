@@ -0,0 +1,42 @@
+#include "branch_parser.hpp"
+
+#include <stdexcept>
+
+#include "catch2/catch_test_macros.hpp"
+
+using namespace palloc;
+
+TEST_CASE("Base case - [Branch Parser]") {
+    const SimulatorSettings baseSettings{.timesteps = 100,
+                                         .batchInterval = 2,
+                                         .commitInterval = 0,
+                                         .seed = 1,
+                                         .useWeightedParking = false,
+                                         .randomGenerator = "pcg"};
+
+    const auto branches = BranchParser::parse(
+        "batch-interval=5, batch-size=20; commit-interval=10, weighted-parking=true;",
+        baseSettings);
+
+    REQUIRE(branches.size() == 3);
+    REQUIRE(branches[0].batchInterval == 5);
+    REQUIRE(branches[0].commitInterval == 0);
+    REQUIRE(branches[0].batchSize == 20);
+    REQUIRE(branches[1].batchInterval == 2);
+    REQUIRE(branches[1].commitInterval == 10);
+    REQUIRE(branches[1].useWeightedParking);
+    REQUIRE(branches[2] == baseSettings);
+}
+
+TEST_CASE("Invalid overrides - [Branch Parser]") {
+    const SimulatorSettings baseSettings{.timesteps = 100, .batchInterval = 2};
+
+    REQUIRE_THROWS_AS(BranchParser::parse("seed=3", baseSettings), std::invalid_argument);
+    REQUIRE_THROWS_AS(BranchParser::parse("batch-interval", baseSettings), std::invalid_argument);
+    REQUIRE_THROWS_AS(BranchParser::parse("batch-interval=0", baseSettings),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(BranchParser::parse("commit-interval=-1", baseSettings),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(BranchParser::parse("weighted-parking=yes", baseSettings),
+                      std::invalid_argument);
+}
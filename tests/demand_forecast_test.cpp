@@ -0,0 +1,30 @@
+#include "demand_forecast.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+#include "request_generator.hpp"
+
+using namespace palloc;
+
+TEST_CASE("Base case - [Demand Forecast]") {
+    Environment env(Path(PROJECT_ROOT) / "tests/test_data.json");
+    const SimulatorSettings simSettings{.requestRate = 3.0,
+                                        .useWeightedParking = false,
+                                        .horizon = 60};
+
+    DemandForecast forecast(env, simSettings);
+
+    // Every dropoff prefers the first parking and 00:00-01:00 has a single traffic weight
+    const auto expected = std::lround(60 * 3.0 * RequestGenerator::getTimeMultiplier(0));
+    Simulations simulations;
+    auto reservations = forecast.getReservations(0, simulations);
+    REQUIRE(reservations[0] == static_cast<Uint>(expected));
+    REQUIRE(reservations[1] == 0);
+    REQUIRE(reservations[2] == 0);
+
+    SECTION("Departures within the horizon free up reserved spots") {
+        simulations.emplace_back(0, 0, 30, 0, 2);
+        simulations.emplace_back(0, 0, 120, 0, 2);
+        reservations = forecast.getReservations(0, simulations);
+        REQUIRE(reservations[0] == static_cast<Uint>(expected - 1));
+    }
+}
@@ -0,0 +1,63 @@
+#include "environment_loader.hpp"
+
+#include <fstream>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+
+using namespace palloc;
+
+static Path writeEnvironment(const std::string &contents) {
+    const Path path = Path(PROJECT_ROOT) / "tests/temp_environment.json";
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+    return path;
+}
+
+TEST_CASE("Base case - [Environment Loader]") {
+    const Path testDataPath = Path(PROJECT_ROOT) / "tests/test_data.json";
+
+    SECTION("Chunk size does not change the result") {
+        for (const size_t chunkSize : {size_t{1}, size_t{7}, size_t{1} << 20}) {
+            EnvironmentLoader loader(testDataPath, {}, chunkSize);
+            const auto data = loader.load();
+
+            REQUIRE(data.travelTimes.getNumberOfDropoffs() == 3);
+            REQUIRE(data.travelTimes.getNumberOfParkings() == 3);
+            REQUIRE(data.travelTimes.getRoundTrip(0, 1) == 6);
+            REQUIRE(data.parkingCapacities == UintVector{3, 5, 9});
+            REQUIRE(data.dropoffCoords.size() == 3);
+            REQUIRE(loader.getBytesRead() == std::filesystem::file_size(testDataPath));
+        }
+    }
+
+    SECTION("Key order and unknown keys are handled") {
+        const auto path = writeEnvironment(
+            R"({ "parking_coords": [{"lon": 2.5, "lat": 1.5}],
+                 "unknown": {"nested": [1, "x", true, null, -2.5e3]},
+                 "parking_to_dropoff": [[3, 4]],
+                 "dropoff_to_parking": [[1], [2]],
+                 "parking_capacities": [7] })");
+        const auto data = EnvironmentLoader(path, {}).load();
+
+        REQUIRE(data.travelTimes.getRoundTrip(0, 0) == 4);
+        REQUIRE(data.travelTimes.getRoundTrip(1, 0) == 6);
+        REQUIRE(data.parkingCoords[0].latitude == 1.5);
+        REQUIRE(data.parkingCapacities == UintVector{7});
+        std::filesystem::remove(path);
+    }
+
+    SECTION("Mismatched dimensions are rejected") {
+        const auto path = writeEnvironment(
+            R"({"dropoff_to_parking": [[1, 2]], "parking_to_dropoff": [[1], [2]],
+                "parking_capacities": [1, 2, 3]})");
+        REQUIRE_THROWS_AS(EnvironmentLoader(path, {}).load(), std::runtime_error);
+        std::filesystem::remove(path);
+    }
+
+    SECTION("Truncated files are rejected") {
+        const auto path = writeEnvironment(R"({"dropoff_to_parking": [[1, 2], [3)");
+        REQUIRE_THROWS_AS(EnvironmentLoader(path, {}).load(), std::runtime_error);
+        std::filesystem::remove(path);
+    }
+}
@@ -0,0 +1,53 @@
+#include "feasibility_mask.hpp"
+
+#include <random>
+
+#include "catch2/catch_test_macros.hpp"
+
+using namespace palloc;
+
+using Durations = std::vector<TravelTimes::Duration>;
+
+TEST_CASE("Feasible entries are set - [Feasibility Mask]", "[Feasibility Mask]") {
+    const Durations toParking{1, 5, 0, 65535, 3};
+    const Durations toDropoff{1, 5, 0, 65535, 4};
+
+    FeasibilityMask::Words mask;
+    FeasibilityMask::compute(toParking, toDropoff, 7, mask);
+    REQUIRE(mask == FeasibilityMask::Words{0b10101});
+
+    // Both legs at their maximum overflow 16 bits but still fit a large enough budget
+    FeasibilityMask::compute(toParking, toDropoff, 2 * 65535, mask);
+    REQUIRE(mask == FeasibilityMask::Words{0b11111});
+
+    FeasibilityMask::compute({}, {}, 7, mask);
+    REQUIRE(mask.empty());
+}
+
+TEST_CASE("Vector kernel matches scalar kernel - [Feasibility Mask]", "[Feasibility Mask]") {
+    INFO("Instruction set " << FeasibilityMask::getInstructionSet());
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> sizeDist(0, 300);
+    for (int scenario = 0; scenario < 500; ++scenario) {
+        // Sizes around the vector widths and word boundaries, with both short and extreme legs
+        const bool extreme = scenario % 4 == 0;
+        std::uniform_int_distribution<TravelTimes::Duration> durationDist(0, extreme ? 65535 : 60);
+        std::uniform_int_distribution<Uint> budgetDist(0, extreme ? 140000 : 130);
+
+        const size_t count = sizeDist(rng);
+        Durations toParking(count);
+        Durations toDropoff(count);
+        for (size_t k = 0; k < count; ++k) {
+            toParking[k] = durationDist(rng);
+            toDropoff[k] = durationDist(rng);
+        }
+
+        const Uint budget = budgetDist(rng);
+        FeasibilityMask::Words vectorMask;
+        FeasibilityMask::Words scalarMask;
+        FeasibilityMask::compute(toParking, toDropoff, budget, vectorMask);
+        FeasibilityMask::computeScalar(toParking, toDropoff, budget, scalarMask);
+        REQUIRE(vectorMask == scalarMask);
+    }
+}
@@ -0,0 +1,164 @@
+#include "memory_account.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <list>
+
+#include "aggregated_result.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "simulator.hpp"
+
+using namespace palloc;
+
+using CountedVector = std::vector<Uint, CountingAllocator<Uint, MemoryCategory::REQUESTS>>;
+using CountedList = std::list<Uint, CountingAllocator<Uint, MemoryCategory::TRACES>>;
+
+TEST_CASE("Counting allocators report to the account in scope - [MemoryAccount]",
+          "[MemoryAccount]") {
+    MemoryAccount account;
+
+    CountedVector outside(100);
+    {
+        const MemoryScope scope(&account);
+        CountedVector first(100);
+        {
+            CountedVector second(50);
+        }
+
+        CountedList list{1, 2, 3};
+    }
+
+    const auto memory = account.getRunMemory();
+    REQUIRE(memory.requests.allocations == 2);
+    REQUIRE(memory.requests.peakBytes == 150 * sizeof(Uint));
+    REQUIRE(memory.traces.allocations == 3);
+    REQUIRE(memory.traces.peakBytes >= 3 * sizeof(Uint));
+    REQUIRE(memory.simulations.allocations == 0);
+    // The list is allocated after second is freed, so the total peaks with both vectors alive
+    REQUIRE(memory.peakBytes == memory.requests.peakBytes);
+}
+
+TEST_CASE("Memory scopes nest and restore the previous account - [MemoryAccount]",
+          "[MemoryAccount]") {
+    MemoryAccount outer;
+    MemoryAccount inner;
+
+    REQUIRE(MemoryAccount::getCurrent() == nullptr);
+    {
+        const MemoryScope outerScope(&outer);
+        {
+            const MemoryScope innerScope(&inner);
+            REQUIRE(MemoryAccount::getCurrent() == &inner);
+            CountedVector vector(10);
+        }
+
+        REQUIRE(MemoryAccount::getCurrent() == &outer);
+    }
+
+    REQUIRE(MemoryAccount::getCurrent() == nullptr);
+    REQUIRE(outer.getRunMemory().peakBytes == 0);
+    REQUIRE(inner.getRunMemory().requests.allocations == 1);
+}
+
+static void requireAccountedRuns(const AggregatedResult &result, Uint numberOfRuns,
+                                 Uint timesteps) {
+    REQUIRE(result.getMemory().has_value());
+
+    const auto &memory = *result.getMemory();
+    REQUIRE(memory.runs.size() == numberOfRuns);
+    REQUIRE(memory.phases.size() == 3);
+    for (const auto &run : memory.runs) {
+        REQUIRE(run.environment.peakBytes > 0);
+        REQUIRE(run.simulations.allocations > 0);
+
+        // One trace node per timestep, with the assignments accounted on their own
+        REQUIRE(run.traces.allocations == timesteps);
+        REQUIRE(run.traces.peakBytes <= timesteps * (sizeof(Trace) + 64));
+    }
+}
+
+TEST_CASE("Simulated runs account their memory - [MemoryAccount]", "[MemoryAccount]") {
+    const Path testDataPath = Path(PROJECT_ROOT) / "tests/test_data.json";
+    const Path tempResultPath = Path(PROJECT_ROOT) / "tests/temp_memory_result.json";
+
+    SimulatorSettings simSettings{.timesteps = 60,
+                                  .startTime = 0,
+                                  .maxRequestDuration = 5,
+                                  .requestRate = 10,
+                                  .maxTimeTillArrival = 5,
+                                  .minParkingTime = 0,
+                                  .batchInterval = 1,
+                                  .commitInterval = 0,
+                                  .seed = 3,
+                                  .useWeightedParking = false,
+                                  .randomGenerator = "pcg",
+                                  .replaySpeed = 1};
+
+    Environment env(testDataPath);
+
+    constexpr Uint numberOfRuns = 2;
+    OutputSettings outputSettings{.outputPath = tempResultPath,
+                                  .numberOfRunsToAggregate = numberOfRuns,
+                                  .prettify = false,
+                                  .outputTrace = true,
+                                  .outputReport = false,
+                                  .accountMemory = true};
+
+    SECTION("Sequential runs") {
+        Simulator::simulate(env, simSettings, outputSettings, {.numberOfThreads = 2});
+    }
+
+    SECTION("Pipelined runs") {
+        Simulator::simulate(env, simSettings, outputSettings,
+                            {.numberOfThreads = 2, .pipelined = true});
+    }
+
+    requireAccountedRuns(AggregatedResult(tempResultPath), numberOfRuns, simSettings.timesteps);
+    std::filesystem::remove(tempResultPath);
+}
+
+// Hidden, run with: palloc_tests "[.benchmark]"
+TEST_CASE("Run memory stays bounded on a long horizon - [Benchmark]", "[.benchmark]") {
+    const Path testDataPath = Path(PROJECT_ROOT) / "tests/test_data.json";
+    const Path tempResultPath = Path(PROJECT_ROOT) / "tests/temp_memory_benchmark.json";
+
+    SimulatorSettings simSettings{.timesteps = 1440,
+                                  .startTime = 0,
+                                  .maxRequestDuration = 60,
+                                  .requestRate = 5,
+                                  .maxTimeTillArrival = 10,
+                                  .minParkingTime = 0,
+                                  .batchInterval = 2,
+                                  .commitInterval = 0,
+                                  .seed = 7,
+                                  .useWeightedParking = false,
+                                  .randomGenerator = "pcg",
+                                  .replaySpeed = 1};
+
+    Environment env(testDataPath);
+
+    OutputSettings outputSettings{.outputPath = tempResultPath,
+                                  .numberOfRunsToAggregate = 4,
+                                  .prettify = false,
+                                  .outputTrace = true,
+                                  .outputReport = false,
+                                  .accountMemory = true};
+    Simulator::simulate(env, simSettings, outputSettings, {.numberOfThreads = 4});
+
+    AggregatedResult result(tempResultPath);
+    requireAccountedRuns(result, 4, simSettings.timesteps);
+
+    // Ongoing simulations are bounded by the capacity, and requests by the request rate over
+    // the longest a request can wait, neither by the number of timesteps
+    const Uint64 spots = 3 + 5 + 9;
+    const Uint64 requestWindow = simSettings.maxTimeTillArrival + simSettings.batchInterval +
+                                 simSettings.maxRequestDuration;
+    const auto liveRequests =
+        static_cast<Uint64>(std::ceil(simSettings.requestRate)) * requestWindow;
+    for (const auto &run : result.getMemory()->runs) {
+        REQUIRE(run.simulations.peakBytes <= 4 * spots * (sizeof(Simulation) + 64));
+        REQUIRE(run.requests.peakBytes <= 8 * liveRequests * sizeof(Request));
+    }
+
+    std::filesystem::remove(tempResultPath);
+}
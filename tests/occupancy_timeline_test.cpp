@@ -0,0 +1,41 @@
+#include "occupancy_timeline.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+
+using namespace palloc;
+
+TEST_CASE("Base case - [Occupancy Timeline]") {
+    OccupancyTimeline timeline(1);
+    timeline.advance(1);
+    timeline.addRelease(0, 5);
+
+    SECTION("Requests share the spots free while they overlap") {
+        const std::vector<OccupancyInterval> intervals{{.request = 0, .start = 5, .end = 10},
+                                                       {.request = 1, .start = 3, .end = 6}};
+        const auto windows = timeline.getCapacityWindows(0, 0, intervals);
+
+        REQUIRE(windows.size() == 2);
+        REQUIRE(windows[0].freeSpots == 0);
+        REQUIRE(windows[0].requests == std::vector<size_t>{1});
+        REQUIRE(windows[1].freeSpots == 1);
+        REQUIRE(windows[1].requests == std::vector<size_t>{0, 1});
+    }
+
+    SECTION("Released spots cannot be claimed twice") {
+        timeline.addClaim(0, 7);
+        const std::vector<OccupancyInterval> intervals{{.request = 0, .start = 8, .end = 12}};
+
+        REQUIRE(timeline.getCapacityWindows(0, 0, intervals).size() == 1);
+        REQUIRE(timeline.getCapacityWindows(0, 1, intervals).empty());
+    }
+
+    SECTION("Advancing forgets past changes") {
+        timeline.advance(5);
+        const std::vector<OccupancyInterval> intervals{{.request = 0, .start = 6, .end = 12}};
+
+        REQUIRE(timeline.getCapacityWindows(0, 0, intervals).size() == 1);
+    }
+
+    REQUIRE(OccupancyTimeline::getReleaseTimestep(10, 2, 20, 3) == 30);
+    REQUIRE(OccupancyTimeline::getReleaseTimestep(10, 2, 20, 0) == 32);
+}
@@ -0,0 +1,88 @@
+#include "report.hpp"
+
+#include <filesystem>
+
+#include "aggregated_result.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "simulator.hpp"
+
+using namespace palloc;
+
+TEST_CASE("Run reports aggregate per timestep - [Report]", "[Report]") {
+    RunReport first(UintVector{2, 4});
+    first.addTimestep({1, 4}, 0, 2.0, 4.0);
+    first.addTimestep({0, 2}, 1, 4.0, 6.0);
+    first.addRouteDuration(3);
+    first.addRouteDuration(3);
+
+    RunReport second(UintVector{2, 4});
+    second.addTimestep({2, 4}, 2, 0.0, 0.0);
+    second.addTimestep({2, 0}, 2, 6.0, 8.0);
+    second.addRouteDuration(1);
+
+    ReportBuilder builder;
+    builder.add(first);
+    builder.add(second);
+    const auto report = builder.build();
+
+    REQUIRE(report.availableSpots.mean == DoubleVector{5.5, 3.0});
+    REQUIRE(report.availableSpots.min == DoubleVector{5.0, 2.0});
+    REQUIRE(report.availableSpots.max == DoubleVector{6.0, 4.0});
+    REQUIRE(report.droppedRequests.mean == DoubleVector{1.0, 1.5});
+    REQUIRE(report.cost.max == DoubleVector{2.0, 6.0});
+    REQUIRE(report.duration.min == DoubleVector{0.0, 6.0});
+    REQUIRE(report.routeDurationHistogram == std::vector<Uint64>{0, 1, 0, 2});
+
+    // Occupied spot minutes over capacity times timesteps of both runs
+    REQUIRE(report.parkingUtilization == DoubleVector{3.0 / 8.0, 6.0 / 16.0});
+}
+
+TEST_CASE("Simulated runs collect reports - [Report]", "[Report]") {
+    const Path testDataPath = Path(PROJECT_ROOT) / "tests/test_data.json";
+    const Path tempResultPath = Path(PROJECT_ROOT) / "tests/temp_report_result.json";
+
+    SimulatorSettings simSettings{.timesteps = 60,
+                                  .startTime = 0,
+                                  .maxRequestDuration = 5,
+                                  .requestRate = 10,
+                                  .maxTimeTillArrival = 5,
+                                  .minParkingTime = 0,
+                                  .batchInterval = 1,
+                                  .commitInterval = 0,
+                                  .seed = 3,
+                                  .useWeightedParking = false,
+                                  .randomGenerator = "pcg",
+                                  .replaySpeed = 1};
+
+    Environment env(testDataPath);
+
+    constexpr Uint numberOfRuns = 3;
+    OutputSettings outputSettings{.outputPath = tempResultPath,
+                                  .numberOfRunsToAggregate = numberOfRuns,
+                                  .prettify = false,
+                                  .outputTrace = false,
+                                  .outputReport = true};
+    Simulator::simulate(env, simSettings, outputSettings, {.numberOfThreads = 2});
+
+    AggregatedResult result(tempResultPath);
+    REQUIRE(result.getReport().has_value());
+
+    const auto &report = *result.getReport();
+    REQUIRE(report.availableSpots.mean.size() == simSettings.timesteps);
+    REQUIRE(report.droppedRequests.max.size() == simSettings.timesteps);
+    REQUIRE(report.parkingUtilization.size() == env.getNumberOfParkings());
+
+    Uint64 assignments = 0;
+    for (const auto count : report.routeDurationHistogram) {
+        assignments += count;
+    }
+
+    REQUIRE(assignments == result.getTotalRequestsScheduled());
+
+    for (size_t t = 0; t < simSettings.timesteps; ++t) {
+        REQUIRE(report.availableSpots.min[t] <= report.availableSpots.mean[t]);
+        REQUIRE(report.availableSpots.mean[t] <= report.availableSpots.max[t]);
+    }
+
+    std::filesystem::remove(tempResultPath);
+}
@@ -1,5 +1,9 @@
 #include "request_generator.hpp"
 
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
 #include "catch2/catch_test_macros.hpp"
 
 using namespace palloc;
@@ -26,4 +30,74 @@ TEST_CASE("Base case - [Request Generator]") {
             REQUIRE(request.getRequestDuration() <= maxRequestDuration);
         }
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Common random numbers share demand - [Request Generator]") {
+    const auto createGenerator = [](double requestRate, Uint run, bool antithetic) {
+        return RequestGenerator({.randomGenerator = "pcg",
+                                 .dropoffNodes = 20,
+                                 .maxTimeTillArrival = 5,
+                                 .maxRequestDuration = 100,
+                                 .seed = 1,
+                                 .requestRate = requestRate,
+                                 .run = run,
+                                 .commonRandomNumbers = true,
+                                 .antithetic = antithetic});
+    };
+
+    SECTION("Different rates share the first requests of every timestep") {
+        auto slow = createGenerator(5, 2, false);
+        auto fast = createGenerator(10, 2, false);
+        for (Uint timestep = 0; timestep < 120; ++timestep) {
+            const auto slowRequests = slow.generate(timestep);
+            const auto fastRequests = fast.generate(timestep);
+            for (size_t i = 0; i < std::min(slowRequests.size(), fastRequests.size()); ++i) {
+                REQUIRE(slowRequests[i].getDropoffNode() == fastRequests[i].getDropoffNode());
+                REQUIRE(slowRequests[i].getRequestDuration() ==
+                        fastRequests[i].getRequestDuration());
+                REQUIRE(slowRequests[i].getArrival() == fastRequests[i].getArrival());
+            }
+        }
+    }
+
+    SECTION("Resumed generator continues its substreams") {
+        auto generator = createGenerator(5, 0, false);
+        auto resumed = createGenerator(5, 0, false);
+        for (Uint timestep = 0; timestep < 10; ++timestep) {
+            generator.generate(timestep);
+        }
+
+        resumed.setState(generator.getState());
+        const auto requests = generator.generate(10);
+        const auto resumedRequests = resumed.generate(10);
+        REQUIRE(resumedRequests.size() == requests.size());
+        for (size_t i = 0; i < requests.size(); ++i) {
+            REQUIRE(resumedRequests[i].getDropoffNode() == requests[i].getDropoffNode());
+        }
+    }
+
+    SECTION("Antithetic runs draw complements") {
+        random::PcgEngine engine(7);
+        random::AntitheticEngine antithetic(std::make_unique<random::PcgEngine>(7));
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE(engine() + antithetic() == random::RandomEngine::max());
+        }
+
+        // Even runs are unaffected by pairing
+        auto paired = createGenerator(5, 0, true);
+        auto unpaired = createGenerator(5, 0, false);
+        REQUIRE(paired.generate(0).size() == unpaired.generate(0).size());
+    }
+
+    SECTION("Antithetic runs require common random numbers") {
+        REQUIRE_THROWS_AS(RequestGenerator({.randomGenerator = "pcg",
+                                            .dropoffNodes = 20,
+                                            .maxTimeTillArrival = 5,
+                                            .maxRequestDuration = 100,
+                                            .seed = 1,
+                                            .requestRate = 5,
+                                            .run = 1,
+                                            .commonRandomNumbers = false,
+                                            .antithetic = true}),
+                          std::invalid_argument);
+    }
+}
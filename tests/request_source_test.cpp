@@ -0,0 +1,65 @@
+#include "request_source.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+#include "request_generator.hpp"
+
+using namespace palloc;
+
+TEST_CASE("Replay matches recording - [Request Source]") {
+    const Path recordingPath = Path(PROJECT_ROOT) / "tests/temp_requests.bin";
+
+    constexpr Uint timesteps = 200;
+    constexpr size_t dropoffNodes = 3;
+    const RequestGeneratorOptions options{.randomGenerator = "pcg",
+                                          .dropoffNodes = dropoffNodes,
+                                          .maxTimeTillArrival = 5,
+                                          .maxRequestDuration = 100,
+                                          .seed = 1,
+                                          .requestRate = 5};
+
+    std::vector<Requests> generated;
+    {
+        RecordingRequestSource recorder(std::make_unique<RequestGenerator>(options),
+                                        recordingPath);
+        for (Uint timestep = 0; timestep < timesteps; ++timestep) {
+            generated.push_back(recorder.generate(timestep));
+        }
+    }
+
+    SECTION("Same requests every timestep") {
+        ReplayRequestSource replay(recordingPath, 1, dropoffNodes);
+        Uint total = 0;
+        for (Uint timestep = 0; timestep < timesteps; ++timestep) {
+            const auto replayed = replay.generate(timestep);
+            REQUIRE(replayed.size() == generated[timestep].size());
+            for (size_t i = 0; i < replayed.size(); ++i) {
+                REQUIRE(replayed[i].getDropoffNode() == generated[timestep][i].getDropoffNode());
+                REQUIRE(replayed[i].getRequestDuration() ==
+                        generated[timestep][i].getRequestDuration());
+                REQUIRE(replayed[i].getArrival() == generated[timestep][i].getArrival());
+            }
+
+            total += static_cast<Uint>(replayed.size());
+        }
+
+        REQUIRE(replay.generate(timesteps).empty());
+        REQUIRE(replay.getRequestsGenerated() == total);
+    }
+
+    SECTION("Accelerated replay merges timesteps") {
+        constexpr Uint speed = 4;
+        ReplayRequestSource replay(recordingPath, speed, dropoffNodes);
+        for (Uint step = 0; step < timesteps / speed; ++step) {
+            size_t expected = 0;
+            for (Uint offset = 0; offset < speed; ++offset) {
+                expected += generated[step * speed + offset].size();
+            }
+
+            REQUIRE(replay.generate(step).size() == expected);
+        }
+    }
+
+    SECTION("Dropoffs outside the environment are rejected") {
+        REQUIRE_THROWS(ReplayRequestSource(recordingPath, 1, 0));
+    }
+}
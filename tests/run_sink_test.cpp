@@ -0,0 +1,57 @@
+#include "run_sink.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+#include "simulator.hpp"
+
+using namespace palloc;
+
+namespace {
+struct CountingSink {
+    size_t *events;
+
+    void batchSolved(const BatchEvent &) { ++*events; }
+    void simulationStarted(Uint, const Simulation &) { ++*events; }
+    void arrivedAtParking(Uint, const Simulation &) { ++*events; }
+    void departed(Uint, const Simulation &) { ++*events; }
+    void requestDropped(Uint, const Request &) { ++*events; }
+    void timestepEnded(const TimestepEvent &) { ++*events; }
+};
+}  // namespace
+
+static_assert(RunSink<NullSink>);
+static_assert(RunSink<SinkChain<NullSink, CountingSink>>);
+
+TEST_CASE("Sink chains forward every event - [Run Sink]", "[Run Sink]") {
+    size_t first = 0;
+    size_t second = 0;
+    SinkChain chain(CountingSink{&first}, NullSink{}, CountingSink{&second});
+
+    const Simulation simulation(0, 1, 10, 0, 4);
+    const UintVector availableParkingSpots{1, 2};
+    chain.batchSolved({.timestep = 1, .processedRequests = 2, .totalCost = 3.0});
+    chain.simulationStarted(1, simulation);
+    chain.arrivedAtParking(2, simulation);
+    chain.departed(8, simulation);
+    chain.requestDropped(1, Request(0, 10, 0));
+    chain.timestepEnded({.timestep = 1,
+                         .timeOfDay = 0,
+                         .pendingRequests = 0,
+                         .ongoingSimulations = 1,
+                         .availableParkingSpots = availableParkingSpots,
+                         .droppedRequests = 1,
+                         .earlyRequests = 0});
+
+    REQUIRE(first == 6);
+    REQUIRE(second == 6);
+}
+
+TEST_CASE("Batch events average over their requests - [Run Sink]", "[Run Sink]") {
+    const BatchEvent empty{};
+    REQUIRE(empty.getAverageCost() == 0.0);
+    REQUIRE(empty.getAverageDuration() == 0.0);
+
+    const BatchEvent batch{.processedRequests = 4, .scheduled = 2, .totalCost = 6.0,
+                           .totalDuration = 10};
+    REQUIRE(batch.getAverageCost() == 1.5);
+    REQUIRE(batch.getAverageDuration() == 5.0);
+}
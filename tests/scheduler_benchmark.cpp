@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <random>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "environment.hpp"
+#include "scheduler.hpp"
+
+using namespace palloc;
+
+/**
+ * City with enough spots for every request, so batches take the fast path and the time goes to
+ * the kernels instead of the solver
+ */
+static EnvironmentData generateCity(std::mt19937 &rng, Uint numberOfDropoffs,
+                                    Uint numberOfParkings) {
+    std::uniform_int_distribution<Uint> durationDist(1, 30);
+    std::uniform_real_distribution<double> offsetDist(0.0, 0.1);
+
+    TravelTimesBuilder builder(StorageSettings{});
+    for (Uint i = 0; i < numberOfDropoffs; ++i) {
+        UintVector row(numberOfParkings);
+        std::ranges::generate(row, [&]() { return durationDist(rng); });
+        builder.addDropoffRow(row);
+    }
+
+    builder.endDropoffRows();
+    for (Uint j = 0; j < numberOfParkings; ++j) {
+        UintVector row(numberOfDropoffs);
+        std::ranges::generate(row, [&]() { return durationDist(rng); });
+        builder.addParkingRow(row);
+    }
+
+    EnvironmentData data;
+    data.travelTimes = builder.build();
+    for (Uint i = 0; i < numberOfDropoffs; ++i) {
+        data.dropoffCoords.push_back({.latitude = 57.0 + offsetDist(rng),
+                                      .longitude = 9.9 + offsetDist(rng)});
+    }
+
+    for (Uint j = 0; j < numberOfParkings; ++j) {
+        data.parkingCapacities.push_back(10000);
+        data.parkingWeights.push_back(1.0 + offsetDist(rng));
+        data.parkingCoords.push_back({.latitude = 57.0 + offsetDist(rng),
+                                      .longitude = 9.9 + offsetDist(rng)});
+    }
+
+    return data;
+}
+
+// Hidden, run with: palloc_tests "[.benchmark]"
+TEST_CASE("Specialized and generic batch kernels - [Benchmark]", "[.benchmark]") {
+    std::mt19937 rng(3);
+    const Environment env(generateCity(rng, 100, 400));
+
+    std::uniform_int_distribution<Uint> dropoffDist(0, 99);
+    std::uniform_int_distribution<Uint> durationDist(60, 600);
+    Requests batch;
+    for (Uint id = 0; id < 2000; ++id) {
+        batch.emplace_back(dropoffDist(rng), durationDist(rng), 0).setId(id);
+    }
+
+    SimulatorSettings simSettings{.useWeightedParking = false, .schedulerBackend = "auto"};
+
+    // Both kernels pay for copying the environment and batch they consume
+    const auto schedule = [&](bool genericKernels) {
+        Environment batchEnv = env;
+        Requests requests = batch;
+        return Scheduler::scheduleBatch(batchEnv, requests, simSettings,
+                                        {.genericKernels = genericKernels})
+            .objective;
+    };
+
+    BENCHMARK("Specialized kernel") { return schedule(false); };
+    BENCHMARK("Generic kernel") { return schedule(true); };
+
+    simSettings.useWeightedParking = true;
+    BENCHMARK("Specialized kernel, weighted parking") { return schedule(false); };
+    BENCHMARK("Generic kernel, weighted parking") { return schedule(true); };
+}
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+#include "environment.hpp"
+#include "occupancy_timeline.hpp"
+#include "scheduler.hpp"
+
+using namespace palloc;
+
+struct Scenario {
+    EnvironmentData data;
+    Requests requests;
+    SimulatorSettings simSettings;
+    UintVector reservedSpots;
+    std::optional<OccupancyTimeline> timeline;
+};
+
+static Scenario generateScenario(std::mt19937 &rng) {
+    const auto uniform = [&rng](Uint min, Uint max) {
+        return std::uniform_int_distribution<Uint>(min, max)(rng);
+    };
+
+    Scenario scenario;
+    const Uint numberOfDropoffs = uniform(1, 5);
+    const Uint numberOfParkings = uniform(1, 4);
+
+    const bool limitStorage = uniform(0, 3) == 0;
+    const StorageSettings storageSettings{.travelTimeCutoff = limitStorage ? uniform(4, 30) : 0,
+                                          .nearestParkings = limitStorage ? uniform(0, 3) : 0};
+    TravelTimesBuilder builder(storageSettings);
+    for (Uint i = 0; i < numberOfDropoffs; ++i) {
+        UintVector row(numberOfParkings);
+        for (auto &duration : row) {
+            duration = uniform(0, 12);
+        }
+
+        builder.addDropoffRow(row);
+    }
+
+    builder.endDropoffRows();
+    for (Uint j = 0; j < numberOfParkings; ++j) {
+        UintVector row(numberOfDropoffs);
+        for (auto &duration : row) {
+            duration = uniform(0, 12);
+        }
+
+        builder.addParkingRow(row);
+    }
+
+    auto &data = scenario.data;
+    data.travelTimes = builder.build();
+    for (Uint i = 0; i < numberOfDropoffs; ++i) {
+        data.dropoffCoords.push_back({.latitude = 57.0 + uniform(0, 100) / 1000.0,
+                                      .longitude = 9.9 + uniform(0, 100) / 1000.0});
+    }
+
+    const bool useWeights = uniform(0, 1) == 1;
+    for (Uint j = 0; j < numberOfParkings; ++j) {
+        data.parkingCapacities.push_back(uniform(0, 3));
+        data.parkingCoords.push_back({.latitude = 57.0 + uniform(0, 100) / 1000.0,
+                                      .longitude = 9.9 + uniform(0, 100) / 1000.0});
+        if (useWeights) {
+            data.parkingWeights.push_back(uniform(5, 15) / 10.0);
+        }
+    }
+
+    const Uint requestCount = uniform(1, 10);
+    for (Uint id = 0; id < requestCount; ++id) {
+        auto &request =
+            scenario.requests.emplace_back(uniform(0, numberOfDropoffs - 1), uniform(1, 40),
+                                           uniform(0, 1) == 0 ? 0 : uniform(0, 5));
+        request.setId(id);
+        const Uint timesDropped = uniform(0, 2);
+        for (Uint k = 0; k < timesDropped; ++k) {
+            request.incrementTimesDropped();
+        }
+    }
+
+    scenario.simSettings = {.minParkingTime = uniform(0, 3),
+                            .commitInterval = uniform(0, 3),
+                            .useWeightedParking = useWeights && uniform(0, 1) == 1};
+
+    if (uniform(0, 2) == 0) {
+        for (Uint j = 0; j < numberOfParkings; ++j) {
+            scenario.reservedSpots.push_back(uniform(0, 2));
+        }
+    }
+
+    if (uniform(0, 3) == 0) {
+        auto &timeline = scenario.timeline.emplace(numberOfParkings);
+        timeline.advance(1);
+        for (Uint events = uniform(0, 4); events > 0; --events) {
+            timeline.addRelease(uniform(0, numberOfParkings - 1), uniform(2, 20));
+        }
+    }
+
+    return scenario;
+}
+
+/**
+ * Exhaustive search over every capacity respecting assignment, independent of the scheduler
+ */
+static Int64 findOptimalObjective(const Environment &env, const Scenario &scenario) {
+    const auto &requests = scenario.requests;
+    const auto &simSettings = scenario.simSettings;
+    const auto &availableParkingSpots = env.getAvailableParkingSpots();
+    const auto &reservedSpots = scenario.reservedSpots;
+    UintVector usedSpots(env.getNumberOfParkings(), 0);
+
+    const auto getReservationCost = [&]() {
+        Int64 cost = 0;
+        for (size_t j = 0; j < reservedSpots.size(); ++j) {
+            const Int64 unreserved = std::max<Int64>(
+                static_cast<Int64>(availableParkingSpots[j]) - reservedSpots[j], 0);
+            if (reservedSpots[j] > 0 && usedSpots[j] > unreserved) {
+                cost += Scheduler::RESERVATION_PENALTY * (usedSpots[j] - unreserved);
+            }
+        }
+
+        return cost;
+    };
+
+    Int64 best = std::numeric_limits<Int64>::max();
+    const auto search = [&](auto &self, size_t i, Int64 cost) -> void {
+        if (i == requests.size()) {
+            best = std::min(best, cost + getReservationCost());
+            return;
+        }
+
+        const auto &request = requests[i];
+        const auto penalty =
+            static_cast<Int64>(Scheduler::UNASSIGNED_PENALTY) * (1 + request.getTimesDropped());
+        self(self, i + 1, cost + penalty);
+
+        const auto row = env.getTravelTimes()->getRow(request.getDropoffNode());
+        for (size_t k = 0; k < row.parkings.size(); ++k) {
+            const auto parkingNode = row.parkings[k];
+            const auto roundTrip = row.getRoundTrip(k);
+            if (roundTrip + simSettings.minParkingTime > request.getRequestDuration() ||
+                usedSpots[parkingNode] == availableParkingSpots[parkingNode]) {
+                continue;
+            }
+
+            const Int64 parkingCost =
+                simSettings.useWeightedParking
+                    ? std::lround(roundTrip * env.getParkingWeights()[parkingNode])
+                    : roundTrip;
+            ++usedSpots[parkingNode];
+            self(self, i + 1, cost + parkingCost);
+            --usedSpots[parkingNode];
+        }
+    };
+
+    search(search, 0, 0);
+    return best;
+}
+
+static void checkResult(const Scenario &scenario, const Environment &before,
+                        const Environment &after, const SchedulerResult &result) {
+    const auto &simSettings = scenario.simSettings;
+    const bool commitAll = scenario.timeline.has_value();
+
+    // Every request ends up in exactly one of the outputs
+    std::multiset<Uint> ids;
+    for (const auto &simulation : result.simulations) {
+        ids.insert(simulation.getRequestId());
+    }
+
+    for (const auto &request : result.unassignedRequests) {
+        ids.insert(request.getId());
+        REQUIRE(request.getArrival() == 0);
+    }
+
+    for (const auto &request : result.earlyRequests) {
+        ids.insert(request.getId());
+        REQUIRE(request.getArrival() > 0);
+    }
+
+    REQUIRE(ids.size() == scenario.requests.size());
+    for (const auto &request : scenario.requests) {
+        REQUIRE(ids.count(request.getId()) == 1);
+        if (request.getArrival() > simSettings.commitInterval && !commitAll) {
+            REQUIRE(std::ranges::count(result.earlyRequests, request.getId(), &Request::getId) ==
+                    1);
+        }
+    }
+
+    // Spots are taken now unless claimed on a later arrival, and never beyond capacity
+    UintVector takenSpots(before.getNumberOfParkings(), 0);
+    for (const auto &simulation : result.simulations) {
+        const auto parkingNode = simulation.getParkingNode();
+        REQUIRE(simulation.getRouteDuration() + simSettings.minParkingTime <=
+                simulation.getRequestDuration());
+        REQUIRE(simulation.hasPendingClaim() == (commitAll && simulation.getEarlyTimeLeft() > 0));
+        if (!simulation.hasPendingClaim()) {
+            ++takenSpots[parkingNode];
+        }
+    }
+
+    for (size_t j = 0; j < takenSpots.size(); ++j) {
+        REQUIRE(takenSpots[j] <= before.getAvailableParkingSpots()[j]);
+        REQUIRE(after.getAvailableParkingSpots()[j] ==
+                before.getAvailableParkingSpots()[j] - takenSpots[j]);
+    }
+}
+
+static Uint getSoakSeconds() {
+    const char *soakSeconds = std::getenv("PALLOC_SOAK_SECONDS");
+    return soakSeconds == nullptr ? 0 : static_cast<Uint>(std::strtoul(soakSeconds, nullptr, 10));
+}
+
+TEST_CASE("Backends agree on random batches - [Scheduler]", "[Scheduler]") {
+    // Set PALLOC_SOAK_SECONDS to keep generating batches for that long
+    const auto soakSeconds = getSoakSeconds();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(soakSeconds);
+    constexpr Uint minimumScenarios = 200;
+
+    std::mt19937 rng(42);
+    for (Uint scenarioNumber = 0;
+         scenarioNumber < minimumScenarios || std::chrono::steady_clock::now() < deadline;
+         ++scenarioNumber) {
+        const auto scenario = generateScenario(rng);
+        const Environment env(scenario.data);
+        const SchedulerContext context{
+            .reservedSpots = scenario.reservedSpots,
+            .timeline = scenario.timeline ? &*scenario.timeline : nullptr};
+
+        std::optional<Int64> objective;
+        for (const auto &backend : Scheduler::availableBackends) {
+            INFO("Scenario " << scenarioNumber << " with backend " << backend);
+            auto simSettings = scenario.simSettings;
+            simSettings.schedulerBackend = backend;
+            Environment backendEnv = env;
+            Requests requests = scenario.requests;
+
+            const auto result =
+                Scheduler::scheduleBatch(backendEnv, requests, simSettings, context);
+            checkResult(scenario, env, backendEnv, result);
+
+            // The kernel specialized on the settings must not change the batch
+            SchedulerContext genericContext = context;
+            genericContext.genericKernels = true;
+            Environment genericEnv = env;
+            Requests genericRequests = scenario.requests;
+            const auto genericResult =
+                Scheduler::scheduleBatch(genericEnv, genericRequests, simSettings, genericContext);
+            REQUIRE(genericResult.objective == result.objective);
+            REQUIRE(genericResult.totalCost == result.totalCost);
+            REQUIRE(genericResult.simulations.size() == result.simulations.size());
+            REQUIRE(genericResult.earlyRequests.size() == result.earlyRequests.size());
+
+            if (!objective) {
+                objective = result.objective;
+            }
+
+            REQUIRE(result.objective == *objective);
+        }
+
+        // Capacity over time is not part of the exhaustive search
+        if (!scenario.timeline) {
+            REQUIRE(*objective == findOptimalObjective(env, scenario));
+        }
+    }
+}
@@ -88,6 +88,30 @@ TEST_CASE("Multiple requests - [Scheduler]") {
         REQUIRE(batchResult.earlyRequests.empty());
         REQUIRE(batchResult.totalCost > Scheduler::UNASSIGNED_PENALTY);
         REQUIRE(batchResult.totalCost < 2 * Scheduler::UNASSIGNED_PENALTY);
+        REQUIRE_FALSE(batchResult.usedFastPath);
+
+        // Only the first parking is close enough, so each request has one candidate
+        REQUIRE(batchResult.variableCount == 2 * requestAmount);
+    }
+
+    SECTION("Fast path without contention") {
+        Requests requests;
+        const auto capacity = env.getAvailableParkingSpots()[0];
+        for (size_t i = 0; i < capacity; ++i) {
+            requests.emplace_back(0, 10, 0);
+        }
+
+        const auto candidates = Scheduler::getCandidates(env, requests, simSettings);
+        const auto greedy = Scheduler::assignGreedily(env, requests, candidates);
+        REQUIRE(greedy.isOptimal);
+        REQUIRE(greedy.lowerBound == static_cast<Int64>(2 * capacity));
+
+        const auto batchResult = Scheduler::scheduleBatch(env, requests, simSettings);
+
+        REQUIRE(batchResult.usedFastPath);
+        REQUIRE(batchResult.variableCount == 0);
+        REQUIRE(batchResult.simulations.size() == capacity);
+        REQUIRE(batchResult.totalCost == static_cast<double>(2 * capacity));
     }
 
     SECTION("Multiple unassigned requests") {
@@ -105,4 +129,54 @@ TEST_CASE("Multiple requests - [Scheduler]") {
         REQUIRE(batchResult.totalCost ==
                 static_cast<double>(requestAmount * Scheduler::UNASSIGNED_PENALTY));
     }
-}
\ No newline at end of file
+
+    SECTION("Reserved spots are avoided") {
+        Requests requests;
+        requests.emplace_back(0, 100, 0);
+
+        const SchedulerContext context{.reservedSpots = {env.getAvailableParkingSpots()[0], 0, 0}};
+        const auto batchResult = Scheduler::scheduleBatch(env, requests, simSettings, context);
+
+        REQUIRE_FALSE(batchResult.usedFastPath);
+        REQUIRE(batchResult.simulations.size() == 1);
+        REQUIRE(batchResult.simulations.front().getParkingNode() == 1);
+        REQUIRE(batchResult.totalCost == 6.0);
+    }
+
+    SECTION("Identical requests share class variables") {
+        Requests requests;
+        for (size_t i = 0; i < 10; ++i) {
+            requests.emplace_back(0, 10, 0);
+        }
+
+        Environment requestEnv = env;
+        Requests requestModelRequests = requests;
+        simSettings.schedulerBackend = "cp-sat";
+        const auto requestResult =
+            Scheduler::scheduleBatch(requestEnv, requestModelRequests, simSettings);
+
+        simSettings.schedulerBackend = "aggregated";
+        const auto classResult = Scheduler::scheduleBatch(env, requests, simSettings);
+
+        REQUIRE(classResult.objective == requestResult.objective);
+        REQUIRE(classResult.simulations.size() == requestResult.simulations.size());
+        REQUIRE(env.getAvailableParkingSpots() == requestEnv.getAvailableParkingSpots());
+        REQUIRE(classResult.variableCount == 1 + env.getNumberOfParkings());
+        REQUIRE(requestResult.variableCount == 10 * (1 + env.getNumberOfParkings()));
+    }
+
+    SECTION("Early requests are committed against a timeline") {
+        Requests requests;
+        requests.emplace_back(0, 10, 3);
+
+        const OccupancyTimeline timeline(env.getNumberOfParkings());
+        const SchedulerContext context{.timeline = &timeline};
+        const auto availableBefore = env.getAvailableParkingSpots()[0];
+        const auto batchResult = Scheduler::scheduleBatch(env, requests, simSettings, context);
+
+        REQUIRE(batchResult.earlyRequests.empty());
+        REQUIRE(batchResult.simulations.size() == 1);
+        REQUIRE(batchResult.simulations.front().hasPendingClaim());
+        REQUIRE(env.getAvailableParkingSpots()[0] == availableBefore);
+    }
+}
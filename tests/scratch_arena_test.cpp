@@ -0,0 +1,69 @@
+#include "scratch_arena.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+#include "environment.hpp"
+#include "scheduler.hpp"
+
+using namespace palloc;
+
+TEST_CASE("Arena stops allocating once it fits a batch - [ScratchArena]", "[ScratchArena]") {
+    ScratchArena arena(64);
+
+    const auto allocateBatch = [&arena]() {
+        std::pmr::vector<std::pmr::vector<Uint>> rows(16, arena.getResource());
+        for (auto &row : rows) {
+            for (Uint i = 0; i < 100; ++i) {
+                row.push_back(i);
+            }
+        }
+    };
+
+    allocateBatch();
+    arena.reset();
+    const auto upstreamAllocations = arena.getUpstreamAllocations();
+    REQUIRE(upstreamAllocations > 0);
+    REQUIRE(arena.getCapacity() > 64);
+
+    for (int batch = 0; batch < 10; ++batch) {
+        allocateBatch();
+        arena.reset();
+    }
+
+    REQUIRE(arena.getUpstreamAllocations() == upstreamAllocations);
+}
+
+TEST_CASE("Scheduling through an arena - [ScratchArena]", "[ScratchArena]") {
+    const Environment env(Path(PROJECT_ROOT) / "tests/test_data.json");
+    SimulatorSettings simSettings{.minParkingTime = 0, .commitInterval = 0};
+    simSettings.schedulerBackend = "cp-sat";
+
+    // More requests than the closest parking has spots, so the solver builds a model
+    Requests requests;
+    for (Uint i = 0; i < 6; ++i) {
+        requests.emplace_back(0, 10, 0);
+    }
+
+    Environment heapEnv = env;
+    Requests heapRequests = requests;
+    const auto expected = Scheduler::scheduleBatch(heapEnv, heapRequests, simSettings);
+
+    ScratchArena arena;
+    size_t upstreamAllocations = 0;
+    for (int batch = 0; batch < 5; ++batch) {
+        Environment batchEnv = env;
+        Requests batchRequests = requests;
+        const auto result =
+            Scheduler::scheduleBatch(batchEnv, batchRequests, simSettings, {.arena = &arena});
+
+        REQUIRE(result.objective == expected.objective);
+        REQUIRE(result.simulations.size() == expected.simulations.size());
+        REQUIRE(batchEnv.getAvailableParkingSpots() == heapEnv.getAvailableParkingSpots());
+        arena.reset();
+
+        if (batch == 1) {
+            upstreamAllocations = arena.getUpstreamAllocations();
+        } else if (batch > 1) {
+            REQUIRE(arena.getUpstreamAllocations() == upstreamAllocations);
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include "shard.hpp"
+
+#include <filesystem>
+#include <stdexcept>
+
+#include "aggregated_result.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "simulator.hpp"
+
+using namespace palloc;
+
+TEST_CASE("Shards partition the jobs - [Shard]", "[Shard]") {
+    REQUIRE(Shard::parse("2/5") == std::pair<Uint, Uint>{2, 5});
+    REQUIRE_THROWS_AS(Shard::parse("5/5"), std::invalid_argument);
+    REQUIRE_THROWS_AS(Shard::parse("1"), std::invalid_argument);
+    REQUIRE_THROWS_AS(Shard::parse("a/2"), std::invalid_argument);
+
+    REQUIRE(Shard::getJobs(7, 1, 3) == std::vector<Uint>{1, 4});
+    REQUIRE(Shard::getJobs(3, 0, 1) == std::vector<Uint>{0, 1, 2});
+    REQUIRE(Shard::getJobs(2, 2, 3).empty());
+}
+
+TEST_CASE("Merged shards match a single process - [Shard]", "[Shard]") {
+    const Path testDataPath = Path(PROJECT_ROOT) / "tests/test_data.json";
+    const Path singleResultPath = Path(PROJECT_ROOT) / "tests/temp_single_result.json";
+    const Path mergedResultPath = Path(PROJECT_ROOT) / "tests/temp_merged_result.json";
+
+    SimulatorSettings simSettings{.timesteps = 120,
+                                  .startTime = 0,
+                                  .maxRequestDuration = 5,
+                                  .requestRate = 10,
+                                  .maxTimeTillArrival = 5,
+                                  .minParkingTime = 0,
+                                  .batchInterval = 2,
+                                  .commitInterval = 0,
+                                  .seed = 7,
+                                  .useWeightedParking = false,
+                                  .randomGenerator = "pcg",
+                                  .replaySpeed = 1};
+
+    Environment env(testDataPath);
+
+    constexpr Uint numberOfRuns = 5;
+    OutputSettings singleSettings{.outputPath = singleResultPath,
+                                  .numberOfRunsToAggregate = numberOfRuns,
+                                  .prettify = false,
+                                  .outputTrace = true};
+    Simulator::simulate(env, simSettings, singleSettings, {.numberOfThreads = 1});
+
+    // Each shard stands in for a machine of its own
+    constexpr Uint shardCount = 3;
+    std::vector<Path> shardPaths;
+    for (Uint shard = 0; shard < shardCount; ++shard) {
+        OutputSettings shardSettings = singleSettings;
+        shardSettings.outputPath =
+            Path(PROJECT_ROOT) / ("tests/temp_shard_" + std::to_string(shard) + ".json");
+        shardSettings.shardIndex = shard;
+        shardSettings.shardCount = shardCount;
+        Simulator::simulate(env, simSettings, shardSettings, {.numberOfThreads = 2});
+        shardPaths.push_back(shardSettings.outputPath);
+    }
+
+    // Order of the shard files does not matter
+    std::swap(shardPaths.front(), shardPaths.back());
+    Shard::merge(shardPaths, mergedResultPath);
+
+    AggregatedResult single(singleResultPath);
+    AggregatedResult merged(mergedResultPath);
+
+    REQUIRE(merged.getAvgCost() == single.getAvgCost());
+    REQUIRE(merged.getAvgDuration() == single.getAvgDuration());
+    REQUIRE(merged.getAvgVariableCount() == single.getAvgVariableCount());
+    REQUIRE(merged.getTotalRequestsGenerated() == single.getTotalRequestsGenerated());
+    REQUIRE(merged.getTotalRequestsScheduled() == single.getTotalRequestsScheduled());
+    REQUIRE(merged.getTotalDroppedRequests() == single.getTotalDroppedRequests());
+    REQUIRE(merged.getTotalBatches() == single.getTotalBatches());
+
+    const auto singleTraces = single.getTraceLists();
+    const auto mergedTraces = merged.getTraceLists();
+    REQUIRE(mergedTraces.size() == numberOfRuns);
+    for (size_t run = 0; run < numberOfRuns; ++run) {
+        REQUIRE(mergedTraces[run].size() == singleTraces[run].size());
+
+        auto mergedTrace = mergedTraces[run].begin();
+        for (const auto &singleTrace : singleTraces[run]) {
+            REQUIRE(mergedTrace->getNumberOfRequests() == singleTrace.getNumberOfRequests());
+            REQUIRE(mergedTrace->getAverageCost() == singleTrace.getAverageCost());
+            ++mergedTrace;
+        }
+    }
+
+    // A missing shard cannot be merged
+    shardPaths.pop_back();
+    REQUIRE_THROWS_AS(Shard::merge(shardPaths, mergedResultPath), std::runtime_error);
+
+    for (const auto &path : {singleResultPath, mergedResultPath}) {
+        std::filesystem::remove(path);
+    }
+
+    for (Uint shard = 0; shard < shardCount; ++shard) {
+        std::filesystem::remove(Path(PROJECT_ROOT) /
+                                ("tests/temp_shard_" + std::to_string(shard) + ".json"));
+    }
+}
@@ -0,0 +1,131 @@
+#include "simulation_run.hpp"
+
+#include <filesystem>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+
+#include "aggregated_result.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+using namespace palloc;
+
+static SimulatorSettings getSimSettings() {
+    return {.timesteps = 60,
+            .startTime = 1430,
+            .maxRequestDuration = 5,
+            .requestRate = 10,
+            .maxTimeTillArrival = 5,
+            .minParkingTime = 0,
+            .batchInterval = 2,
+            .commitInterval = 0,
+            .seed = 3,
+            .useWeightedParking = false,
+            .randomGenerator = "pcg",
+            .replaySpeed = 1};
+}
+
+TEST_CASE("Stepping a run matches simulating it - [SimulationRun]", "[SimulationRun]") {
+    const Path testDataPath = Path(PROJECT_ROOT) / "tests/test_data.json";
+    const Path tempResultPath = Path(PROJECT_ROOT) / "tests/temp_simulation_run_result.json";
+
+    const auto simSettings = getSimSettings();
+    Environment env(testDataPath);
+
+    OutputSettings outputSettings{.outputPath = tempResultPath,
+                                  .numberOfRunsToAggregate = 1,
+                                  .prettify = false,
+                                  .outputTrace = false};
+    Simulator::simulate(env, simSettings, outputSettings, {.numberOfThreads = 1});
+    AggregatedResult result(tempResultPath);
+    std::filesystem::remove(tempResultPath);
+
+    SimulationRun run(env, simSettings);
+    while (!run.isFinished()) {
+        run.step();
+    }
+
+    const auto metrics = run.getMetrics();
+    REQUIRE(run.getTimestep() == simSettings.timesteps);
+    REQUIRE(metrics.requestsGenerated == result.getTotalRequestsGenerated());
+    REQUIRE(metrics.requestsScheduled == result.getTotalRequestsScheduled());
+    REQUIRE(metrics.droppedRequests == result.getTotalDroppedRequests());
+    REQUIRE(metrics.batches == result.getTotalBatches());
+    REQUIRE(metrics.getAverageDuration() == result.getAvgDuration());
+
+    REQUIRE_THROWS_AS(run.step(), std::runtime_error);
+}
+
+TEST_CASE("Snapshots view the state of every timestep - [SimulationRun]", "[SimulationRun]") {
+    const Path testDataPath = Path(PROJECT_ROOT) / "tests/test_data.json";
+    const auto simSettings = getSimSettings();
+    const Environment env(testDataPath);
+    const auto &capacities = env.getAvailableParkingSpots();
+    const Uint totalCapacity = std::reduce(capacities.begin(), capacities.end());
+
+    SimulationRun run(env, simSettings);
+
+    Uint expectedTimestep = 1;
+    size_t scheduled = 0;
+    for (const auto &snapshot : run.steps()) {
+        REQUIRE(snapshot.timestep == expectedTimestep);
+        REQUIRE(snapshot.timeOfDay == (simSettings.startTime + expectedTimestep - 1) % 1440);
+        REQUIRE(snapshot.availableParkingSpots.data() ==
+                run.getEnvironment().getAvailableParkingSpots().data());
+
+        // Every occupied spot is held by an ongoing simulation
+        const Uint freeSpots = std::reduce(snapshot.availableParkingSpots.begin(),
+                                           snapshot.availableParkingSpots.end());
+        REQUIRE(freeSpots + snapshot.simulations.size() >= totalCapacity);
+
+        const auto started = std::ranges::distance(snapshot.startedSimulations);
+        REQUIRE(static_cast<size_t>(started) == snapshot.batch.scheduled);
+        scheduled += snapshot.batch.scheduled;
+        REQUIRE(snapshot.metrics.requestsScheduled == scheduled);
+
+        if (snapshot.batch.timestep == 0) {
+            REQUIRE(snapshot.droppedRequests.empty());
+        }
+
+        // Stop early like a caller which has seen enough
+        if (expectedTimestep == 20) {
+            break;
+        }
+
+        ++expectedTimestep;
+    }
+
+    REQUIRE(run.getTimestep() == 20);
+    REQUIRE_FALSE(run.isFinished());
+
+    for (const auto &snapshot : run.steps()) {
+        REQUIRE(snapshot.timestep == ++expectedTimestep);
+    }
+
+    REQUIRE(run.getTimestep() == simSettings.timesteps);
+    REQUIRE(run.isFinished());
+}
+
+TEST_CASE("Interleaved runs do not affect each other - [SimulationRun]", "[SimulationRun]") {
+    const Path testDataPath = Path(PROJECT_ROOT) / "tests/test_data.json";
+    const auto simSettings = getSimSettings();
+    const Environment env(testDataPath);
+
+    SimulationRun alone(env, simSettings, 1);
+    while (!alone.isFinished()) {
+        alone.step();
+    }
+
+    SimulationRun first(env, simSettings, 0);
+    SimulationRun second(env, simSettings, 1);
+    while (!second.isFinished()) {
+        first.step();
+        second.step();
+    }
+
+    REQUIRE(second.getMetrics().requestsGenerated == alone.getMetrics().requestsGenerated);
+    REQUIRE(second.getMetrics().requestsScheduled == alone.getMetrics().requestsScheduled);
+    REQUIRE(second.getMetrics().totalCost == alone.getMetrics().totalCost);
+    REQUIRE(second.getEnvironment().getAvailableParkingSpots() ==
+            alone.getEnvironment().getAvailableParkingSpots());
+}
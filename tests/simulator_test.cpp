@@ -1,5 +1,7 @@
 #include "simulator.hpp"
 #include "aggregated_result.hpp"
+#include "checkpoint.hpp"
+#include "utils.hpp"
 
 #include "catch2/catch_test_macros.hpp"
 
@@ -86,4 +88,290 @@ TEST_CASE("Base case - [Simulator]") {
         tempDropAmount = trace.getDroppedRequests() - tempDropAmount;
         earlierTrace = trace;
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Resume from checkpoint - [Simulator]") {
+    const Path testDataPath = Path(PROJECT_ROOT) / "tests/test_data.json";
+    const Path straightResultPath = Path(PROJECT_ROOT) / "tests/temp_straight_result.json";
+    const Path resumedResultPath = Path(PROJECT_ROOT) / "tests/temp_resumed_result.json";
+    const Path checkpointPath = Path(PROJECT_ROOT) / "tests/temp_checkpoint.beve";
+
+    GeneralSettings generalSettings{.numberOfThreads = 1};
+    SimulatorSettings simSettings{.timesteps = 300,
+                                  .startTime = 0,
+                                  .maxRequestDuration = 5,
+                                  .requestRate = 10,
+                                  .maxTimeTillArrival = 5,
+                                  .minParkingTime = 0,
+                                  .batchInterval = 2,
+                                  .commitInterval = 0,
+                                  .seed = 1,
+                                  .useWeightedParking = false,
+                                  .randomGenerator = "pcg",
+                                  .replaySpeed = 1};
+
+    Environment env(testDataPath);
+
+    OutputSettings straightSettings{.outputPath = straightResultPath,
+                                    .numberOfRunsToAggregate = 1,
+                                    .prettify = false,
+                                    .outputTrace = true};
+    Simulator::simulate(env, simSettings, straightSettings, generalSettings);
+
+    // Stop halfway, then resume the same run up to the full number of timesteps. A horizon
+    // which is not a multiple of the batch interval forces a batch at its end that the full
+    // run does not solve
+    std::filesystem::remove(checkpointPath);
+    OutputSettings resumedSettings{.outputPath = resumedResultPath,
+                                   .numberOfRunsToAggregate = 1,
+                                   .prettify = false,
+                                   .outputTrace = true,
+                                   .checkpointPath = checkpointPath,
+                                   .checkpointInterval = 50,
+                                   .resume = true};
+    SimulatorSettings halfSettings = simSettings;
+    SECTION("Half on a batch boundary") { halfSettings.timesteps = simSettings.timesteps / 2; }
+    SECTION("Half off a batch boundary") { halfSettings.timesteps = simSettings.timesteps / 2 + 1; }
+
+    REQUIRE(halfSettings.timesteps < simSettings.timesteps);
+    Simulator::simulate(env, halfSettings, resumedSettings, generalSettings);
+    Simulator::simulate(env, simSettings, resumedSettings, generalSettings);
+
+    AggregatedResult straight(straightResultPath);
+    AggregatedResult resumed(resumedResultPath);
+
+    REQUIRE(resumed.getTotalRequestsGenerated() == straight.getTotalRequestsGenerated());
+    REQUIRE(resumed.getTotalRequestsScheduled() == straight.getTotalRequestsScheduled());
+    REQUIRE(resumed.getTotalDroppedRequests() == straight.getTotalDroppedRequests());
+    REQUIRE(resumed.getAvgCost() == straight.getAvgCost());
+    REQUIRE(resumed.getAvgDuration() == straight.getAvgDuration());
+    REQUIRE(resumed.getTraceLists()[0].size() == straight.getTraceLists()[0].size());
+
+    // The final checkpoint is the one before the last timestep, and nothing earlier resumes it
+    REQUIRE(Checkpoint::load(checkpointPath, simSettings, 0).timestep == simSettings.timesteps - 1);
+    halfSettings.timesteps = simSettings.timesteps - 1;
+    REQUIRE_THROWS_AS(Checkpoint::load(checkpointPath, halfSettings, 0), std::runtime_error);
+
+    std::filesystem::remove(checkpointPath);
+}
+
+TEST_CASE("Branch from shared warm-up - [Simulator]") {
+    const Path testDataPath = Path(PROJECT_ROOT) / "tests/test_data.json";
+    const Path straightResultPath = Path(PROJECT_ROOT) / "tests/temp_straight_result.json";
+    const Path branchResultPath = Path(PROJECT_ROOT) / "tests/temp_branch_result.json";
+
+    GeneralSettings generalSettings{.numberOfThreads = 2};
+    SimulatorSettings simSettings{.timesteps = 300,
+                                  .startTime = 0,
+                                  .maxRequestDuration = 5,
+                                  .requestRate = 10,
+                                  .maxTimeTillArrival = 5,
+                                  .minParkingTime = 0,
+                                  .batchInterval = 2,
+                                  .commitInterval = 0,
+                                  .seed = 1,
+                                  .useWeightedParking = false,
+                                  .randomGenerator = "pcg",
+                                  .replaySpeed = 1,
+                                  .warmupTimesteps = 0};
+
+    Environment env(testDataPath);
+
+    OutputSettings straightSettings{.outputPath = straightResultPath,
+                                    .numberOfRunsToAggregate = 2,
+                                    .prettify = false,
+                                    .outputTrace = true};
+    Simulator::simulate(env, simSettings, straightSettings, generalSettings);
+
+    // A branch keeping the warm-up policy must continue exactly like an unbranched run
+    SimulatorSettings warmupSettings = simSettings;
+    warmupSettings.warmupTimesteps = 150;
+    SimulatorSettings otherBranch = warmupSettings;
+    otherBranch.batchInterval = 5;
+
+    OutputSettings branchSettings{.outputPath = branchResultPath,
+                                  .numberOfRunsToAggregate = 2,
+                                  .prettify = false,
+                                  .outputTrace = true};
+    Simulator::simulateBranches(env, warmupSettings, {warmupSettings, otherBranch}, branchSettings,
+                                generalSettings);
+
+    AggregatedResult straight(straightResultPath);
+    AggregatedResult sameBranch(utils::getBranchPath(branchResultPath, 0));
+    AggregatedResult forkedBranch(utils::getBranchPath(branchResultPath, 1));
+
+    REQUIRE(sameBranch.getTotalRequestsGenerated() == straight.getTotalRequestsGenerated());
+    REQUIRE(sameBranch.getTotalRequestsScheduled() == straight.getTotalRequestsScheduled());
+    REQUIRE(sameBranch.getTotalDroppedRequests() == straight.getTotalDroppedRequests());
+    REQUIRE(sameBranch.getAvgDuration() == straight.getAvgDuration());
+    REQUIRE(forkedBranch.getTotalRequestsGenerated() == straight.getTotalRequestsGenerated());
+
+    for (const auto &traces : forkedBranch.getTraceLists()) {
+        REQUIRE(traces.size() == simSettings.timesteps);
+    }
+}
+
+TEST_CASE("Results independent of thread count - [Simulator]") {
+    const Path testDataPath = Path(PROJECT_ROOT) / "tests/test_data.json";
+    const Path serialResultPath = Path(PROJECT_ROOT) / "tests/temp_serial_result.json";
+    const Path parallelResultPath = Path(PROJECT_ROOT) / "tests/temp_parallel_result.json";
+
+    SimulatorSettings simSettings{.timesteps = 200,
+                                  .startTime = 0,
+                                  .maxRequestDuration = 5,
+                                  .requestRate = 10,
+                                  .maxTimeTillArrival = 5,
+                                  .minParkingTime = 0,
+                                  .batchInterval = 2,
+                                  .commitInterval = 0,
+                                  .seed = 1,
+                                  .useWeightedParking = false,
+                                  .randomGenerator = "pcg",
+                                  .replaySpeed = 1};
+
+    Environment env(testDataPath);
+
+    constexpr Uint numberOfRuns = 4;
+    OutputSettings serialSettings{.outputPath = serialResultPath,
+                                  .numberOfRunsToAggregate = numberOfRuns,
+                                  .prettify = false,
+                                  .outputTrace = true};
+    Simulator::simulate(env, simSettings, serialSettings, {.numberOfThreads = 1});
+
+    OutputSettings parallelSettings = serialSettings;
+    parallelSettings.outputPath = parallelResultPath;
+    Simulator::simulate(env, simSettings, parallelSettings, {.numberOfThreads = numberOfRuns});
+
+    AggregatedResult serial(serialResultPath);
+    AggregatedResult parallel(parallelResultPath);
+
+    REQUIRE(parallel.getAvgCost() == serial.getAvgCost());
+    REQUIRE(parallel.getAvgDuration() == serial.getAvgDuration());
+
+    const auto serialTraces = serial.getTraceLists();
+    const auto parallelTraces = parallel.getTraceLists();
+    REQUIRE(parallelTraces.size() == serialTraces.size());
+    for (size_t run = 0; run < serialTraces.size(); ++run) {
+        REQUIRE(parallelTraces[run].size() == serialTraces[run].size());
+
+        auto parallelTrace = parallelTraces[run].begin();
+        for (const auto &serialTrace : serialTraces[run]) {
+            REQUIRE(parallelTrace->getNumberOfRequests() == serialTrace.getNumberOfRequests());
+            REQUIRE(parallelTrace->getAverageCost() == serialTrace.getAverageCost());
+            ++parallelTrace;
+        }
+    }
+}
+
+TEST_CASE("Pipelined run matches sequential run - [Simulator]") {
+    const Path testDataPath = Path(PROJECT_ROOT) / "tests/test_data.json";
+    const Path sequentialResultPath = Path(PROJECT_ROOT) / "tests/temp_sequential_result.json";
+    const Path pipelinedResultPath = Path(PROJECT_ROOT) / "tests/temp_pipelined_result.json";
+
+    SimulatorSettings simSettings{.timesteps = 300,
+                                  .startTime = 0,
+                                  .maxRequestDuration = 5,
+                                  .requestRate = 10,
+                                  .maxTimeTillArrival = 5,
+                                  .minParkingTime = 0,
+                                  .batchInterval = 2,
+                                  .commitInterval = 0,
+                                  .seed = 3,
+                                  .useWeightedParking = false,
+                                  .randomGenerator = "pcg",
+                                  .replaySpeed = 1};
+
+    Environment env(testDataPath);
+
+    OutputSettings sequentialSettings{.outputPath = sequentialResultPath,
+                                      .numberOfRunsToAggregate = 1,
+                                      .prettify = false,
+                                      .outputTrace = true};
+    Simulator::simulate(env, simSettings, sequentialSettings,
+                        {.numberOfThreads = 1, .pipelined = false});
+
+    OutputSettings pipelinedSettings = sequentialSettings;
+    pipelinedSettings.outputPath = pipelinedResultPath;
+    Simulator::simulate(env, simSettings, pipelinedSettings,
+                        {.numberOfThreads = 1, .pipelined = true});
+
+    AggregatedResult sequential(sequentialResultPath);
+    AggregatedResult pipelined(pipelinedResultPath);
+
+    REQUIRE(pipelined.getTotalRequestsGenerated() == sequential.getTotalRequestsGenerated());
+    REQUIRE(pipelined.getAvgCost() == sequential.getAvgCost());
+
+    const auto sequentialTraces = sequential.getTraceLists()[0];
+    const auto pipelinedTraces = pipelined.getTraceLists()[0];
+    REQUIRE(pipelinedTraces.size() == sequentialTraces.size());
+
+    auto pipelinedTrace = pipelinedTraces.begin();
+    for (const auto &sequentialTrace : sequentialTraces) {
+        REQUIRE(pipelinedTrace->getTimeStep() == sequentialTrace.getTimeStep());
+        REQUIRE(pipelinedTrace->getNumberOfRequests() == sequentialTrace.getNumberOfRequests());
+        REQUIRE(pipelinedTrace->getAssignments().size() ==
+                sequentialTrace.getAssignments().size());
+        ++pipelinedTrace;
+    }
+
+    std::filesystem::remove(sequentialResultPath);
+    std::filesystem::remove(pipelinedResultPath);
+}
+
+TEST_CASE("Adaptive batching - [Simulator]") {
+    const SimulatorSettings simSettings{.timesteps = 100,
+                                        .minParkingTime = 1,
+                                        .batchInterval = 10,
+                                        .commitInterval = 3,
+                                        .batchSize = 3};
+    const UintVector smallestRoundTrips{2, 6, 10};
+    RunState state;
+
+    SECTION("Nothing pending waits") {
+        REQUIRE_FALSE(Simulator::isBatchingStep(state, simSettings, smallestRoundTrips, 10));
+        REQUIRE(Simulator::isBatchingStep(state, simSettings, smallestRoundTrips, 100));
+    }
+
+    SECTION("Batch size of new requests triggers a solve") {
+        state.requests.assign(2, Request(0, 20, 0));
+        state.pendingSince = 5;
+        REQUIRE_FALSE(Simulator::isBatchingStep(state, simSettings, smallestRoundTrips, 6));
+
+        // Dropped requests wait for their own deadline
+        state.unassignedRequests.assign(3, Request(1, 20, 0));
+        REQUIRE_FALSE(Simulator::isBatchingStep(state, simSettings, smallestRoundTrips, 6));
+
+        state.requests.emplace_back(1, 20, 0);
+        REQUIRE(Simulator::isBatchingStep(state, simSettings, smallestRoundTrips, 6));
+    }
+
+    SECTION("Latency deadline triggers a solve") {
+        state.requests.emplace_back(0, 20, 0);
+        state.pendingSince = 5;
+        REQUIRE_FALSE(Simulator::isBatchingStep(state, simSettings, smallestRoundTrips, 14));
+        REQUIRE(Simulator::isBatchingStep(state, simSettings, smallestRoundTrips, 15));
+    }
+
+    SECTION("Early requests entering the commit window force a solve") {
+        state.earlyRequests.emplace_back(0, 20, 4);
+        REQUIRE_FALSE(Simulator::isBatchingStep(state, simSettings, smallestRoundTrips, 7));
+
+        state.earlyRequests.front().decrementTillArrival();
+        REQUIRE(Simulator::isBatchingStep(state, simSettings, smallestRoundTrips, 8));
+    }
+
+    SECTION("Dropped requests about to expire force a solve") {
+        state.unassignedRequests.emplace_back(1, 8, 0);
+        REQUIRE_FALSE(Simulator::isBatchingStep(state, simSettings, smallestRoundTrips, 7));
+
+        state.unassignedRequests.front().decrementDuration();
+        REQUIRE(Simulator::isBatchingStep(state, simSettings, smallestRoundTrips, 8));
+    }
+
+    SECTION("Fixed interval without a batch size") {
+        auto fixedSettings = simSettings;
+        fixedSettings.batchSize = 0;
+        state.requests.assign(5, Request(0, 20, 0));
+        REQUIRE_FALSE(Simulator::isBatchingStep(state, fixedSettings, smallestRoundTrips, 9));
+        REQUIRE(Simulator::isBatchingStep(state, fixedSettings, smallestRoundTrips, 10));
+    }
+}
@@ -0,0 +1,64 @@
+#include "spatial_index.hpp"
+
+#include <algorithm>
+
+#include "catch2/catch_test_macros.hpp"
+#include "environment.hpp"
+
+using namespace palloc;
+
+TEST_CASE("Base case - [Spatial Index]") {
+    std::vector<Point> points;
+    for (int x = 0; x < 10; ++x) {
+        for (int y = 0; y < 10; ++y) {
+            points.push_back({.x = x * 100.0, .y = y * 100.0});
+        }
+    }
+    const SpatialIndex index(points);
+    SpatialIndex::Indices result;
+
+    SECTION("Query matches a brute force scan") {
+        const Point center{.x = 420.0, .y = 370.0};
+        const double radius = 250.0;
+        index.query(center, radius, result);
+
+        SpatialIndex::Indices expected;
+        for (Uint i = 0; i < points.size(); ++i) {
+            const double dx = points[i].x - center.x;
+            const double dy = points[i].y - center.y;
+            if (dx * dx + dy * dy <= radius * radius) {
+                expected.push_back(i);
+            }
+        }
+
+        REQUIRE(!expected.empty());
+        REQUIRE(result == expected);
+    }
+
+    SECTION("Points outside the grid are found") {
+        index.query({.x = -1000.0, .y = -1000.0}, 1500.0, result);
+        REQUIRE(result == SpatialIndex::Indices{0, 1, 10});
+    }
+
+    SECTION("Empty radius finds nothing far away") {
+        index.query({.x = 5000.0, .y = 5000.0}, 10.0, result);
+        REQUIRE(result.empty());
+    }
+}
+
+TEST_CASE("Reachable parkings contain all feasible parkings - [Spatial Index]") {
+    const Environment env(Path(PROJECT_ROOT) / "tests/test_data.json");
+    REQUIRE(env.canPruneParkings());
+    SpatialIndex::Indices reachable;
+
+    for (Uint dropoff = 0; dropoff < env.getNumberOfDropoffs(); ++dropoff) {
+        for (Uint budget = 0; budget <= 20; ++budget) {
+            env.getReachableParkings(dropoff, budget, reachable);
+            for (Uint parking = 0; parking < env.getNumberOfParkings(); ++parking) {
+                if (env.getRoundTrip(dropoff, parking) <= budget) {
+                    REQUIRE(std::ranges::find(reachable, parking) != reachable.end());
+                }
+            }
+        }
+    }
+}
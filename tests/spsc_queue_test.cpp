@@ -0,0 +1,44 @@
+#include "spsc_queue.hpp"
+
+#include <thread>
+
+#include "catch2/catch_test_macros.hpp"
+
+using namespace palloc;
+
+TEST_CASE("Values arrive in order across threads - [SpscQueue]", "[SpscQueue]") {
+    SpscQueue<size_t> queue(4);
+    constexpr size_t count = 100000;
+
+    std::thread producer([&queue]() {
+        for (size_t i = 0; i < count; ++i) {
+            queue.push(i);
+        }
+
+        queue.close();
+    });
+
+    size_t expected = 0;
+    while (const auto value = queue.pop()) {
+        REQUIRE(*value == expected);
+        ++expected;
+    }
+
+    producer.join();
+    REQUIRE(expected == count);
+}
+
+TEST_CASE("Closing wakes a waiting producer - [SpscQueue]", "[SpscQueue]") {
+    SpscQueue<int> queue(1);
+    REQUIRE(queue.push(1));
+
+    bool pushed = true;
+    std::thread producer([&queue, &pushed]() { pushed = queue.push(2); });
+
+    queue.close();
+    producer.join();
+
+    REQUIRE_FALSE(pushed);
+    REQUIRE(queue.pop() == 1);
+    REQUIRE_FALSE(queue.pop().has_value());
+}
@@ -0,0 +1,94 @@
+#include "travel_times.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+
+using namespace palloc;
+
+static TravelTimes buildTravelTimes(const StorageSettings &storageSettings,
+                                    bool parkingRowsFirst = false) {
+    const std::vector<UintVector> dropoffToParking{{1, 2, 3}, {4, 5, 6}};
+    const std::vector<UintVector> parkingToDropoff{{1, 4}, {2, 5}, {3, 70000}};
+
+    TravelTimesBuilder builder(storageSettings);
+    if (parkingRowsFirst) {
+        for (const auto &row : parkingToDropoff) {
+            builder.addParkingRow(row);
+        }
+    }
+
+    for (const auto &row : dropoffToParking) {
+        builder.addDropoffRow(row);
+    }
+
+    builder.endDropoffRows();
+    if (!parkingRowsFirst) {
+        for (const auto &row : parkingToDropoff) {
+            builder.addParkingRow(row);
+        }
+    }
+
+    return builder.build();
+}
+
+TEST_CASE("Base case - [Travel Times]") {
+    SECTION("All pairs are kept without limits") {
+        const auto travelTimes = buildTravelTimes({});
+
+        REQUIRE(travelTimes.getNumberOfDropoffs() == 2);
+        REQUIRE(travelTimes.getNumberOfParkings() == 3);
+        REQUIRE(travelTimes.getDropoffToParking(0, 2) == 3);
+        REQUIRE(travelTimes.getParkingToDropoff(2, 0) == 3);
+        REQUIRE(travelTimes.getRoundTrip(1, 1) == 10);
+
+        // The return leg does not fit the compressed durations
+        const auto row = travelTimes.getRow(1);
+        REQUIRE(row.parkings.size() == 2);
+        REQUIRE(!row.find(2).has_value());
+        REQUIRE(travelTimes.getNumberOfEntries() == 5);
+    }
+
+    SECTION("Row order does not matter") {
+        const auto travelTimes = buildTravelTimes({}, true);
+
+        REQUIRE(travelTimes.getNumberOfEntries() == 5);
+        REQUIRE(travelTimes.getRoundTrip(1, 0) == 8);
+    }
+
+    SECTION("Cutoff drops long round trips") {
+        const auto travelTimes = buildTravelTimes({.travelTimeCutoff = 8, .nearestParkings = 0});
+
+        REQUIRE(travelTimes.getRow(0).parkings.size() == 3);
+        REQUIRE(travelTimes.getRow(1).parkings.size() == 1);
+        REQUIRE(travelTimes.getRoundTrip(1, 0) == 8);
+        REQUIRE(travelTimes.getSmallestRoundTrips() == UintVector{2, 8});
+    }
+
+    SECTION("Dropoffs without parkings are unreachable") {
+        const auto travelTimes = buildTravelTimes({.travelTimeCutoff = 1, .nearestParkings = 0});
+
+        REQUIRE(travelTimes.getNumberOfEntries() == 0);
+        REQUIRE(travelTimes.getSmallestRoundTrips() ==
+                UintVector{TravelTimes::UNREACHABLE, TravelTimes::UNREACHABLE});
+    }
+
+    SECTION("Nearest parkings are kept in ascending order") {
+        const auto travelTimes = buildTravelTimes({.travelTimeCutoff = 0, .nearestParkings = 2});
+        const auto row = travelTimes.getRow(0);
+
+        REQUIRE(row.parkings.size() == 2);
+        REQUIRE(row.parkings[0] == 0);
+        REQUIRE(row.parkings[1] == 1);
+        REQUIRE(row.offset == 0);
+        REQUIRE(travelTimes.getRow(1).offset == 2);
+    }
+
+    SECTION("Rows of the wrong size are rejected") {
+        TravelTimesBuilder builder({});
+        builder.addDropoffRow(UintVector{1, 2, 3});
+        REQUIRE_THROWS_AS(builder.addDropoffRow(UintVector{1, 2}), std::invalid_argument);
+
+        builder.endDropoffRows();
+        REQUIRE_THROWS_AS(builder.addParkingRow(UintVector{1, 2}), std::invalid_argument);
+        REQUIRE_THROWS_AS(builder.build(), std::invalid_argument);
+    }
+}